@@ -0,0 +1,108 @@
+/**
+ * @file compression.cpp
+ * @brief Measure compression ratio and cost per coding on typical JSON API bodies
+ *
+ * Compresses generated JSON bodies of 2 KB, 16 KB and 128 KB with every coding that was
+ * compiled in, through the calling thread's reused Compressor, and reports the compressed
+ * size and time per body. For zlib it also times a context created and destroyed for each
+ * body, which is what reusing contexts avoids.
+ *
+ * Usage: compression [iterations]
+ */
+
+#include "boson/compression.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+std::string jsonBody(size_t size)
+{
+    std::string body = "[";
+    for (int i = 0; body.size() < size; i++)
+    {
+        body += "{\"id\":" + std::to_string(i) + ",\"name\":\"Customer " + std::to_string(i * 7) +
+                "\",\"email\":\"customer" + std::to_string(i) +
+                "@example.com\",\"active\":" + (i % 3 ? "true" : "false") +
+                ",\"balance\":" + std::to_string(i * 13 % 1000) + ".25},";
+    }
+    body.back() = ']';
+    return body;
+}
+
+template <typename F> double nanosPerCall(int iterations, F&& call)
+{
+    for (int i = 0; i < iterations / 10 + 1; i++)
+    {
+        call();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        call();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+/**
+ * @brief Gzip with a context created for this call, as a per-response context would
+ */
+size_t gzipFreshContext(const std::string& input, std::string& out)
+{
+    z_stream stream{};
+    deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    out.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    size_t size = stream.total_out;
+    deflateEnd(&stream);
+    return size;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const boson::ContentEncoding encodings[] = {
+        boson::ContentEncoding::Gzip, boson::ContentEncoding::Deflate,
+        boson::ContentEncoding::Brotli, boson::ContentEncoding::Zstd};
+
+    boson::Compressor& compressor = boson::Compressor::local();
+    std::string out;
+    for (size_t size : {2048, 16384, 131072})
+    {
+        std::string body = jsonBody(size);
+        int rounds = std::max(1, iterations * 2048 / static_cast<int>(size));
+        std::printf("JSON body, %zu bytes:\n", body.size());
+        for (boson::ContentEncoding encoding : encodings)
+        {
+            if (!boson::contentEncodingAvailable(encoding))
+            {
+                continue;
+            }
+            double ns = nanosPerCall(rounds, [&]() { compressor.compress(encoding, body, out); });
+            std::string_view name = boson::contentEncodingName(encoding);
+            std::printf("  %-18.*s %7zu bytes (%5.1f%%)  %9.1f us/body\n",
+                        static_cast<int>(name.size()), name.data(), out.size(),
+                        100.0 * static_cast<double>(out.size()) / body.size(), ns / 1000.0);
+        }
+        size_t freshSize = 0;
+        double fresh = nanosPerCall(rounds, [&]() { freshSize = gzipFreshContext(body, out); });
+        std::printf("  %-18s %7zu bytes (%5.1f%%)  %9.1f us/body\n", "gzip, new context",
+                    freshSize, 100.0 * static_cast<double>(freshSize) / body.size(),
+                    fresh / 1000.0);
+    }
+    return 0;
+}
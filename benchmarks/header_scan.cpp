@@ -0,0 +1,135 @@
+/**
+ * @file header_scan.cpp
+ * @brief Compare the request parser's delimiter-scanning kernels on realistic header blocks
+ *
+ * Builds browser-like requests of roughly 1, 2 and 4 KB (long cookies, user agents, accept
+ * lists) and parses each one repeatedly with every kernel the CPU supports.
+ *
+ * Usage: header_scan [iterations]
+ */
+
+#include "boson/http_parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string makeRequest(size_t targetSize)
+{
+    std::string request =
+        "GET /api/v1/products/12345/reviews?page=2&sort=recent&filter=verified HTTP/1.1\r\n"
+        "Host: shop.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/124.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,"
+        "image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+        "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+        "Accept-Language: en-US,en;q=0.9,de;q=0.8,fr;q=0.7\r\n"
+        "Cache-Control: max-age=0\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: https://shop.example.com/api/v1/products/12345?utm_source=newsletter\r\n"
+        "Sec-Fetch-Dest: document\r\n"
+        "Sec-Fetch-Mode: navigate\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "X-Request-Id: 7f3c2a9e-4b1d-4e8a-9c6f-2d5b8a1e0f47\r\n";
+
+    // Pad with cookies and tracing headers, as real browsers and proxies do
+    std::string cookie = "Cookie: session=9a8b7c6d5e4f3a2b1c0d; theme=dark; consent=1";
+    int index = 0;
+    while (request.size() + cookie.size() + 64 < targetSize)
+    {
+        cookie += "; _ga_" + std::to_string(index) + "=GS1.1.1714000000.12.1.1714000123.0.0." +
+                  std::to_string(index * 7919);
+        index++;
+        if (cookie.size() > 1200)
+        {
+            request += cookie + "\r\n";
+            cookie = "X-Trace-" + std::to_string(index) +
+                     ": 00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+        }
+    }
+    request += cookie + "\r\n\r\n";
+    return request;
+}
+
+const char* kernelName(boson::ScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case boson::ScanKernel::Scalar:
+        return "scalar";
+    case boson::ScanKernel::Sse42:
+        return "sse4.2";
+    case boson::ScanKernel::Avx2:
+        return "avx2";
+    }
+    return "?";
+}
+
+/**
+ * @brief Parse the request repeatedly and return the average time per request in ns
+ */
+double timeParse(const std::string& request, int iterations, size_t& headers)
+{
+    boson::HttpParser parser;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        parser.reset();
+        if (parser.parse(request.data(), request.size()) != boson::HttpParser::Status::Complete)
+        {
+            std::fprintf(stderr, "parse failed\n");
+            std::exit(1);
+        }
+        headers += parser.headers().size();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            start);
+    return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    boson::ScanKernel detected = boson::HttpParser::scanKernel();
+    std::printf("detected kernel: %s, iterations: %d\n", kernelName(detected), iterations);
+
+    const boson::ScanKernel kernels[] = {boson::ScanKernel::Scalar, boson::ScanKernel::Sse42,
+                                         boson::ScanKernel::Avx2};
+    for (size_t size : {1024, 2048, 4096})
+    {
+        std::string request = makeRequest(size);
+        std::printf("\n%zu-byte request:\n", request.size());
+
+        double scalarNs = 0;
+        for (auto kernel : kernels)
+        {
+            if (!boson::HttpParser::setScanKernel(kernel))
+            {
+                std::printf("  %-8s  not supported\n", kernelName(kernel));
+                continue;
+            }
+            size_t headers = 0;
+            timeParse(request, iterations / 10, headers);
+            double ns = timeParse(request, iterations, headers);
+            if (kernel == boson::ScanKernel::Scalar)
+            {
+                scalarNs = ns;
+            }
+            std::printf("  %-8s  %8.1f ns/request  %6.2f GB/s  %5.2fx\n", kernelName(kernel), ns,
+                        static_cast<double>(request.size()) / ns, scalarNs / ns);
+        }
+    }
+
+    boson::HttpParser::setScanKernel(detected);
+    return 0;
+}
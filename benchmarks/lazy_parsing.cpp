@@ -0,0 +1,163 @@
+/**
+ * @file lazy_parsing.cpp
+ * @brief Measure what a request costs when its handler does or does not read parsed fields
+ *
+ * Adopts a parsed GET that carries about 2 KB of cookies and a long query string, and a
+ * multipart/form-data POST with two fields and a 4 KB file, into a Request leased from a
+ * RequestPool, the way the server serves them. Each is measured with a handler that only reads
+ * a header and with one that reads a cookie, a query parameter or the uploaded files,
+ * reporting time and heap allocations per request.
+ *
+ * Usage: lazy_parsing [iterations]
+ */
+
+#include "boson/http_parser.hpp"
+#include "boson/request.hpp"
+#include "boson/request_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+
+std::atomic<size_t> gAllocations{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+std::string cookieGet()
+{
+    std::string cookies;
+    for (int i = 0; i < 40; i++)
+    {
+        cookies += (i ? "; " : "") + std::string("pref_") + std::to_string(i) + "=" +
+                   std::string(40, static_cast<char>('a' + i % 26));
+    }
+    return "GET /dashboard?tab=overview&range=30d&sort=desc&page=4 HTTP/1.1\r\n"
+           "Host: localhost\r\nUser-Agent: bench\r\nAccept: text/html\r\n"
+           "Cookie: session=abc123; " +
+           cookies + "\r\n\r\n";
+}
+
+std::string multipartPost()
+{
+    std::string body = "--XyZ\r\nContent-Disposition: form-data; name=\"title\"\r\n\r\nReport\r\n"
+                       "--XyZ\r\nContent-Disposition: form-data; name=\"tags\"\r\n\r\na,b,c\r\n"
+                       "--XyZ\r\nContent-Disposition: form-data; name=\"file\"; "
+                       "filename=\"data.bin\"\r\nContent-Type: application/octet-stream\r\n\r\n" +
+                       std::string(4096, 'x') + "\r\n--XyZ--\r\n";
+    return "POST /upload HTTP/1.1\r\nHost: localhost\r\n"
+           "Content-Type: multipart/form-data; boundary=XyZ\r\n"
+           "Content-Length: " +
+           std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+template <typename F>
+void measure(const char* name, const std::string& raw, int iterations, F&& handler)
+{
+    boson::HttpParser parser(raw.size() + 1);
+    parser.parse(raw.data(), raw.size());
+    boson::RequestPool pool;
+    size_t sink = 0;
+
+    auto serve = [&]()
+    {
+        boson::RequestPool::Lease lease = pool.acquire();
+        lease.request().setParsedRequest(raw, parser);
+        sink += handler(lease.request());
+    };
+
+    for (int i = 0; i < iterations / 10; i++)
+    {
+        serve();
+    }
+    size_t allocations = gAllocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        serve();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-28s %8.1f ns/request  %6.1f allocs/request\n", name,
+                elapsed.count() / iterations,
+                static_cast<double>(gAllocations.load() - allocations) / iterations);
+    if (sink == 0)
+    {
+        std::printf("    (handler saw nothing)\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    std::string get = cookieGet();
+    std::string post = multipartPost();
+
+    std::printf("GET with %zu byte request head:\n", get.size());
+    measure("header only", get, iterations,
+            [](const boson::Request& req) { return req.headerView("User-Agent").size(); });
+    measure("one cookie", get, iterations,
+            [](const boson::Request& req) { return req.cookie("session").size(); });
+    measure("one query parameter", get, iterations,
+            [](const boson::Request& req) { return req.query("tab").size(); });
+
+    std::printf("\nmultipart POST with %zu byte request:\n", post.size());
+    measure("header only", post, iterations / 10,
+            [](const boson::Request& req) { return req.headerView("Host").size(); });
+    measure("files", post, iterations / 10,
+            [](const boson::Request& req) { return req.files().size(); });
+
+    return 0;
+}
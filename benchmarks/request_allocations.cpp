@@ -0,0 +1,273 @@
+/**
+ * @file request_allocations.cpp
+ * @brief Count global heap allocations per request through the whole server
+ *
+ * Starts a server in this process and sends keep-alive requests to it from a client thread
+ * that only uses fixed buffers, so every operator new counted during the run was made while
+ * serving. Reports allocations and bytes per request for a few typical endpoints.
+ *
+ * A second section builds, fills and serializes a request and response in-process with each
+ * way of providing them: fresh objects on the heap, fresh objects on a RequestArena, and
+ * objects leased from a RequestPool.
+ *
+ * Usage: request_allocations [requests] [port]
+ */
+
+#include "boson/boson.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+std::atomic<size_t> gAllocations{0};
+std::atomic<size_t> gBytes{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+struct Endpoint
+{
+    const char* name;
+    const char* request;
+};
+
+int connectToServer(int port)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+        {
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+/**
+ * @brief Send one request and read until its response has fully arrived
+ */
+bool roundTrip(int fd, const char* request, char* buffer, size_t capacity)
+{
+    size_t length = std::strlen(request);
+    if (send(fd, request, length, 0) != static_cast<ssize_t>(length))
+    {
+        return false;
+    }
+    size_t received = 0;
+    for (;;)
+    {
+        ssize_t n = recv(fd, buffer + received, capacity - received - 1, 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        received += static_cast<size_t>(n);
+        buffer[received] = '\0';
+        const char* end = std::strstr(buffer, "\r\n\r\n");
+        const char* lengthField = std::strstr(buffer, "Content-Length: ");
+        if (end && lengthField)
+        {
+            size_t bodyLength = std::strtoul(lengthField + 16, nullptr, 10);
+            if (received >= static_cast<size_t>(end + 4 - buffer) + bodyLength)
+            {
+                return true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Time one in-process request cycle with objects supplied by withObjects
+ */
+template <typename F> void measureObjects(const char* name, int requests, F&& withObjects)
+{
+    static const char raw[] = "GET /users/42?page=3 HTTP/1.1\r\nHost: localhost\r\n"
+                              "User-Agent: bench\r\nCookie: session=abc; theme=dark\r\n\r\n";
+    boson::HttpParser parser;
+    parser.parse(raw, sizeof(raw) - 1);
+    std::vector<std::string_view> segments;
+
+    auto cycle = [&](boson::Request& request, boson::Response& response)
+    {
+        request.setParsedRequest(std::string_view(raw, sizeof(raw) - 1), parser);
+        request.addRouteParam("id", "42");
+        response.header("Content-Type", "text/plain").send("Hello from a request body buffer");
+        segments.clear();
+        response.serialize(segments);
+    };
+
+    for (int i = 0; i < requests / 10; i++)
+    {
+        withObjects(cycle);
+    }
+    size_t allocations = gAllocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; i++)
+    {
+        withObjects(cycle);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-12s %8.1f ns/request  %5.1f allocs/request\n", name,
+                elapsed.count() / requests,
+                static_cast<double>(gAllocations.load() - allocations) / requests);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int requests = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+    int port = argc > 2 ? std::atoi(argv[2]) : 18090;
+
+    boson::initialize();
+    boson::Server app;
+    app.use([](const boson::Request&, boson::Response& res, boson::NextFunction& next)
+            {
+                res.header("X-Powered-By", "Boson");
+                next();
+            });
+    app.get("/plaintext", [](const boson::Request&, boson::Response& res)
+            { res.header("Content-Type", "text/plain").send("Hello, World!"); });
+    app.get("/users/:id", [](const boson::Request& req, boson::Response& res)
+            {
+                res.jsonObject({{"id", req.param<int>("id")},
+                                {"page", req.query("page")},
+                                {"agent", req.header("User-Agent")}});
+            });
+    app.post("/echo", [](const boson::Request& req, boson::Response& res)
+             { res.status(201).send(req.body()); });
+    app.setMaxRequestsPerConnection(0);
+    app.configure(port, "127.0.0.1");
+    std::thread server([&app]() { app.listen(); });
+
+    const Endpoint endpoints[] = {
+        {"plaintext", "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+        {"json+params", "GET /users/42?page=3&sort=asc HTTP/1.1\r\nHost: localhost\r\n"
+                        "User-Agent: bench\r\nAccept: application/json\r\n"
+                        "Cookie: session=abc; theme=dark\r\n\r\n"},
+        {"post body", "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\n"
+                      "Content-Length: 27\r\n\r\nThe quick brown fox jumped."},
+    };
+
+    static char buffer[65536];
+    int fd = connectToServer(port);
+    if (fd < 0)
+    {
+        std::fprintf(stderr, "could not connect to port %d\n", port);
+        app.stop();
+        server.join();
+        return 1;
+    }
+
+    std::printf("requests per endpoint: %d\n\n", requests);
+    bool ok = true;
+    for (const Endpoint& endpoint : endpoints)
+    {
+        for (int i = 0; i < requests / 10 && ok; i++)
+        {
+            ok = roundTrip(fd, endpoint.request, buffer, sizeof(buffer));
+        }
+        size_t allocations = gAllocations.load();
+        size_t bytes = gBytes.load();
+        for (int i = 0; i < requests && ok; i++)
+        {
+            ok = roundTrip(fd, endpoint.request, buffer, sizeof(buffer));
+        }
+        std::printf("  %-12s %6.1f allocs/request  %8.1f bytes/request\n", endpoint.name,
+                    static_cast<double>(gAllocations.load() - allocations) / requests,
+                    static_cast<double>(gBytes.load() - bytes) / requests);
+    }
+
+    close(fd);
+    app.stop();
+    server.join();
+
+    std::printf("\nrequest and response objects, in-process:\n");
+    measureObjects("heap", requests * 10, [](auto&& cycle) {
+        boson::Request request;
+        boson::Response response;
+        cycle(request, response);
+    });
+    boson::RequestArena arena;
+    measureObjects("arena", requests * 10, [&arena](auto&& cycle) {
+        boson::RequestArena::Scope scope(arena);
+        boson::Request request(arena.resource());
+        boson::Response response(arena.resource());
+        cycle(request, response);
+    });
+    boson::RequestPool pool;
+    measureObjects("pool", requests * 10, [&pool](auto&& cycle) {
+        boson::RequestPool::Lease lease = pool.acquire();
+        cycle(lease.request(), lease.response());
+    });
+
+    return ok ? 0 : 1;
+}
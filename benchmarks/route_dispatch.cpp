@@ -0,0 +1,97 @@
+/**
+ * @file route_dispatch.cpp
+ * @brief Compare controller methods bound at compile time with std::function dispatch
+ *
+ * Registers the same controller method through RouteBinder twice: once from a member function
+ * pointer passed at run time, which the router calls through a RouteHandler std::function, and
+ * once as a template argument, which it calls through a generated function pointer. Reports the
+ * cost of the handler call alone and of a whole Router::handle() for a parameterised route.
+ *
+ * Usage: route_dispatch [iterations]
+ */
+
+#include "boson/route_binder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace
+{
+
+class CounterController : public boson::Controller
+{
+  public:
+    std::string basePath() const override { return ""; }
+
+    void hit(const boson::Request&, boson::Response&) { hits++; }
+
+    size_t hits = 0;
+};
+
+template <typename F> double measure(int iterations, F&& dispatch)
+{
+    for (int i = 0; i < iterations / 10; i++)
+    {
+        dispatch();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        dispatch();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void report(const char* name, double erased, double direct)
+{
+    std::printf("  %-16s std::function %7.2f ns  compile-time %7.2f ns  (%.2fx)\n", name, erased,
+                direct, erased / direct);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000000;
+    std::printf("iterations: %d\n\n", iterations);
+
+    auto controller = std::make_shared<CounterController>();
+    auto erasedBinder = boson::createRouter(controller);
+    erasedBinder.get("/users/:id", &CounterController::hit);
+    auto directBinder = boson::createRouter(controller);
+    directBinder.get<&CounterController::hit>("/users/:id");
+
+    boson::RouterPtr erasedRouter = erasedBinder.getRouter();
+    boson::RouterPtr directRouter = directBinder.getRouter();
+    erasedRouter->freeze();
+    directRouter->freeze();
+
+    boson::Request request;
+    request.setRawRequest("GET /users/42 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    request.parse();
+    boson::Response response;
+
+    // The handler call alone, as the router makes it once a route has matched
+    boson::RouteHandler erasedHandler = [controller](const boson::Request& req,
+                                                     boson::Response& res)
+    { controller->hit(req, res); };
+    boson::DirectHandler directHandler{
+        [](void* target, const boson::Request& req, boson::Response& res)
+        { static_cast<CounterController*>(target)->hit(req, res); },
+        controller};
+    double erasedCall = measure(iterations, [&] { erasedHandler(request, response); });
+    double directCall = measure(iterations, [&] {
+        directHandler.invoke(directHandler.target.get(), request, response);
+    });
+    report("handler call", erasedCall, directCall);
+
+    double erasedRoute = measure(iterations, [&] { erasedRouter->handle(request, response); });
+    double directRoute = measure(iterations, [&] { directRouter->handle(request, response); });
+    report("Router::handle", erasedRoute, directRoute);
+
+    return controller->hits > 0 ? 0 : 1;
+}
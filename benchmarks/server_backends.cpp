@@ -0,0 +1,402 @@
+/**
+ * @file server_backends.cpp
+ * @brief Compare the server I/O backends on requests/s and socket syscalls per request
+ *
+ * The load generator runs in a forked child so the syscall counters in this process only see
+ * the server. Socket-path libc calls are interposed with the linker's --wrap option.
+ *
+ * Usage: server_backends [--backend epoll|reuseport|io_uring|all] [--connections N]
+ *                        [--seconds N] [--pipeline N] [--port N]
+ */
+
+#include "boson/boson.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::atomic<unsigned long long> gSyscalls{0};
+
+inline void countSyscall()
+{
+    gSyscalls.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+extern "C"
+{
+    int __real_accept(int, struct sockaddr*, socklen_t*);
+    int __real_accept4(int, struct sockaddr*, socklen_t*, int);
+    ssize_t __real_read(int, void*, size_t);
+    ssize_t __real_write(int, const void*, size_t);
+    ssize_t __real_recv(int, void*, size_t, int);
+    ssize_t __real_send(int, const void*, size_t, int);
+    ssize_t __real_writev(int, const struct iovec*, int);
+    ssize_t __real_sendfile(int, int, off_t*, size_t);
+    int __real_poll(struct pollfd*, nfds_t, int);
+    int __real_epoll_wait(int, struct epoll_event*, int, int);
+    int __real_epoll_ctl(int, int, int, struct epoll_event*);
+    int __real_shutdown(int, int);
+    int __real_close(int);
+    int __real_setsockopt(int, int, int, const void*, socklen_t);
+    int __real_fcntl(int, int, ...);
+    long __real_syscall(long, ...);
+
+    int __wrap_accept(int fd, struct sockaddr* addr, socklen_t* len)
+    {
+        countSyscall();
+        return __real_accept(fd, addr, len);
+    }
+
+    int __wrap_accept4(int fd, struct sockaddr* addr, socklen_t* len, int flags)
+    {
+        countSyscall();
+        return __real_accept4(fd, addr, len, flags);
+    }
+
+    ssize_t __wrap_read(int fd, void* buf, size_t len)
+    {
+        countSyscall();
+        return __real_read(fd, buf, len);
+    }
+
+    ssize_t __wrap_write(int fd, const void* buf, size_t len)
+    {
+        countSyscall();
+        return __real_write(fd, buf, len);
+    }
+
+    ssize_t __wrap_recv(int fd, void* buf, size_t len, int flags)
+    {
+        countSyscall();
+        return __real_recv(fd, buf, len, flags);
+    }
+
+    ssize_t __wrap_send(int fd, const void* buf, size_t len, int flags)
+    {
+        countSyscall();
+        return __real_send(fd, buf, len, flags);
+    }
+
+    ssize_t __wrap_writev(int fd, const struct iovec* iov, int count)
+    {
+        countSyscall();
+        return __real_writev(fd, iov, count);
+    }
+
+    ssize_t __wrap_sendfile(int out, int in, off_t* offset, size_t count)
+    {
+        countSyscall();
+        return __real_sendfile(out, in, offset, count);
+    }
+
+    int __wrap_poll(struct pollfd* fds, nfds_t count, int timeout)
+    {
+        countSyscall();
+        return __real_poll(fds, count, timeout);
+    }
+
+    int __wrap_epoll_wait(int fd, struct epoll_event* events, int max, int timeout)
+    {
+        countSyscall();
+        return __real_epoll_wait(fd, events, max, timeout);
+    }
+
+    int __wrap_epoll_ctl(int fd, int op, int target, struct epoll_event* event)
+    {
+        countSyscall();
+        return __real_epoll_ctl(fd, op, target, event);
+    }
+
+    int __wrap_shutdown(int fd, int how)
+    {
+        countSyscall();
+        return __real_shutdown(fd, how);
+    }
+
+    int __wrap_close(int fd)
+    {
+        countSyscall();
+        return __real_close(fd);
+    }
+
+    int __wrap_setsockopt(int fd, int level, int name, const void* value, socklen_t len)
+    {
+        countSyscall();
+        return __real_setsockopt(fd, level, name, value, len);
+    }
+
+    int __wrap_fcntl(int fd, int cmd, ...)
+    {
+        va_list args;
+        va_start(args, cmd);
+        long arg = va_arg(args, long);
+        va_end(args);
+        countSyscall();
+        return __real_fcntl(fd, cmd, arg);
+    }
+
+    long __wrap_syscall(long number, ...)
+    {
+        va_list args;
+        va_start(args, number);
+        long a[6];
+        for (long& value : a)
+        {
+            value = va_arg(args, long);
+        }
+        va_end(args);
+        countSyscall();
+        return __real_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+}
+
+namespace
+{
+struct Options
+{
+    std::string backend = "all";
+    int connections = 64;
+    int seconds = 5;
+    int pipeline = 1;
+    int port = 19080;
+};
+
+const char kResponseMarker[] = "\r\n\r\nhello";
+
+/**
+ * @brief Connect to the benchmark server, retrying until it listens or the deadline passes
+ */
+int connectToServer(const Options& options, std::chrono::steady_clock::time_point deadline)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+        {
+            return fd;
+        }
+        __real_close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+/**
+ * @brief Keep one client busy until the deadline, reconnecting whenever the server closes
+ * @return Number of responses received
+ */
+unsigned long long clientConnection(const Options& options,
+                                    std::chrono::steady_clock::time_point deadline)
+{
+    std::string batch;
+    for (int i = 0; i < options.pipeline; i++)
+    {
+        batch += "GET /plaintext HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    unsigned long long completed = 0;
+    std::string pending;
+    char chunk[16384];
+    int fd = -1;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        if (fd < 0)
+        {
+            fd = connectToServer(options, deadline);
+            if (fd < 0)
+            {
+                break;
+            }
+            pending.clear();
+        }
+
+        bool open = __real_send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) ==
+                    static_cast<ssize_t>(batch.size());
+        int outstanding = options.pipeline;
+        while (open && outstanding > 0)
+        {
+            ssize_t n = __real_recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+            {
+                open = false;
+                break;
+            }
+            pending.append(chunk, static_cast<size_t>(n));
+
+            size_t pos = 0;
+            size_t found;
+            while ((found = pending.find(kResponseMarker, pos)) != std::string::npos)
+            {
+                pos = found + sizeof(kResponseMarker) - 1;
+                outstanding--;
+                completed++;
+            }
+            pending.erase(0, pos);
+        }
+
+        if (!open)
+        {
+            __real_close(fd);
+            fd = -1;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        __real_close(fd);
+    }
+    return completed;
+}
+
+/**
+ * @brief Child process body: run the load and report the completed request count on a pipe
+ */
+void runClient(const Options& options, int reportFd)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(options.seconds);
+    std::vector<std::thread> threads;
+    std::vector<unsigned long long> counts(options.connections, 0);
+    for (int i = 0; i < options.connections; i++)
+    {
+        threads.emplace_back([&, i]() { counts[i] = clientConnection(options, deadline); });
+    }
+
+    unsigned long long total = 0;
+    for (int i = 0; i < options.connections; i++)
+    {
+        threads[i].join();
+        total += counts[i];
+    }
+    ssize_t ignored = __real_write(reportFd, &total, sizeof(total));
+    (void)ignored;
+}
+
+void runBackend(const std::string& name, const Options& options)
+{
+    int report[2];
+    if (pipe(report) != 0)
+    {
+        std::perror("pipe");
+        return;
+    }
+
+    // Fork before the server starts any threads
+    pid_t child = fork();
+    if (child == 0)
+    {
+        __real_close(report[0]);
+        runClient(options, report[1]);
+        _exit(0);
+    }
+    __real_close(report[1]);
+
+    boson::Server app;
+    app.get("/plaintext", [](const boson::Request&, boson::Response& res) { res.send("hello"); });
+    if (name == "reuseport")
+    {
+        app.setReusePort(true);
+    }
+    else if (name == "io_uring")
+    {
+        app.setIoBackend(boson::IoBackend::IoUring);
+    }
+    app.configure(options.port, "127.0.0.1");
+
+    gSyscalls.store(0);
+    auto started = std::chrono::steady_clock::now();
+    std::thread server([&app]() { app.listen(); });
+
+    unsigned long long requests = 0;
+    ssize_t got = __real_read(report[0], &requests, sizeof(requests));
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started);
+    unsigned long long syscalls = gSyscalls.load();
+
+    app.stop();
+    server.join();
+    __real_close(report[0]);
+    waitpid(child, nullptr, 0);
+
+    if (got != static_cast<ssize_t>(sizeof(requests)) || requests == 0)
+    {
+        std::printf("%-10s  no requests completed\n", name.c_str());
+        return;
+    }
+    std::printf("%-10s  %12.0f req/s  %8.2f syscalls/req  (%llu requests)\n", name.c_str(),
+                static_cast<double>(requests) / elapsed.count(),
+                static_cast<double>(syscalls) / static_cast<double>(requests), requests);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--backend")
+        {
+            options.backend = value;
+        }
+        else if (flag == "--connections")
+        {
+            options.connections = std::max(1, std::atoi(value.c_str()));
+        }
+        else if (flag == "--seconds")
+        {
+            options.seconds = std::max(1, std::atoi(value.c_str()));
+        }
+        else if (flag == "--pipeline")
+        {
+            options.pipeline = std::max(1, std::atoi(value.c_str()));
+        }
+        else if (flag == "--port")
+        {
+            options.port = std::atoi(value.c_str());
+        }
+    }
+
+    std::printf("connections=%d pipeline=%d seconds=%d\n", options.connections, options.pipeline,
+                options.seconds);
+
+    std::vector<std::string> backends;
+    if (options.backend == "all")
+    {
+        backends = {"epoll", "reuseport", "io_uring"};
+    }
+    else
+    {
+        backends = {options.backend};
+    }
+
+    for (const auto& name : backends)
+    {
+        runBackend(name, options);
+        options.port++;
+    }
+    return 0;
+}
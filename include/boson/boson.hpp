@@ -1,14 +1,22 @@
 #ifndef BOSON_HPP
 #define BOSON_HPP
 
+#include "compression.hpp"
 #include "controller.hpp"
 #include "error_handler.hpp"
+#include "file_watcher.hpp"
+#include "http_date.hpp"
+#include "http_headers.hpp"
+#include "http_status.hpp"
 #include "middleware.hpp"
 #include "request.hpp"
+#include "request_arena.hpp"
+#include "request_pool.hpp"
 #include "response.hpp"
 #include "route_binder.hpp"
 #include "router.hpp"
 #include "server.hpp"
+#include "static_file_cache.hpp"
 #include "static_files.hpp"
 #include "cookie.hpp"
 
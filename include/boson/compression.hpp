@@ -0,0 +1,144 @@
+#ifndef BOSON_COMPRESSION_HPP
+#define BOSON_COMPRESSION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace boson
+{
+
+/**
+ * @brief Content codings the server can apply to a response body
+ */
+enum class ContentEncoding
+{
+    Identity, ///< No compression
+    Gzip,
+    Deflate, ///< The zlib format, as HTTP's "deflate" is defined
+    Brotli,
+    Zstd
+};
+
+/**
+ * @brief Get the Content-Encoding token for a coding
+ * @param encoding The coding
+ * @return "gzip", "deflate", "br", "zstd" or "identity"
+ */
+std::string_view contentEncodingName(ContentEncoding encoding);
+
+/**
+ * @brief Check whether a coding was compiled in
+ *
+ * Gzip and deflate need zlib, Brotli needs libbrotlienc and Zstd needs libzstd; each is built
+ * when CMake finds its library (see BOSON_WITH_ZLIB, BOSON_WITH_BROTLI and BOSON_WITH_ZSTD).
+ */
+bool contentEncodingAvailable(ContentEncoding encoding);
+
+/**
+ * @brief Get the q-value a request's Accept-Encoding gives a coding
+ * @param acceptEncoding The Accept-Encoding header
+ * @param encoding The coding, which need not be compiled in
+ * @return The coding's q-value, or that of "*" if it is not listed; 0 if it is not acceptable
+ */
+double acceptQuality(std::string_view acceptEncoding, ContentEncoding encoding);
+
+/**
+ * @brief When and how responses are compressed
+ */
+struct CompressionOptions
+{
+    /// Bodies smaller than this are sent uncompressed; streamed bodies are not size-checked
+    size_t minSize = 1024;
+
+    /// Compression level in each codec's own scale, or -1 for a default suited to dynamic
+    /// content (gzip and deflate 6, Brotli 5, zstd 3)
+    int level = -1;
+
+    /// Codings to offer, most preferred first; ones that were not compiled in are skipped
+    std::vector<ContentEncoding> encodings = {ContentEncoding::Brotli, ContentEncoding::Zstd,
+                                              ContentEncoding::Gzip, ContentEncoding::Deflate};
+
+    /// Media types worth compressing, matched as prefixes of the Content-Type without case
+    std::vector<std::string> contentTypes = {"text/",
+                                             "application/json",
+                                             "application/javascript",
+                                             "application/xml",
+                                             "application/xhtml+xml",
+                                             "application/problem+json",
+                                             "application/ld+json",
+                                             "application/wasm",
+                                             "image/svg+xml"};
+
+    /**
+     * @brief Check whether a Content-Type is on the allowlist
+     */
+    bool compressible(std::string_view contentType) const;
+
+    /**
+     * @brief Choose the coding for a request
+     * @param acceptEncoding The request's Accept-Encoding header
+     * @return The offered coding the client accepts with the highest q-value, ties going to
+     *         the earlier entry in encodings; Identity if there is none
+     */
+    ContentEncoding negotiate(std::string_view acceptEncoding) const;
+};
+
+/**
+ * @class Compressor
+ * @brief Compression contexts that are reset and reused rather than created per response
+ *
+ * Creating a zlib or zstd context allocates hundreds of kilobytes, so each thread keeps one
+ * Compressor (see local()) and every response it serves reuses the same contexts. A
+ * Compressor runs one stream at a time.
+ */
+class Compressor
+{
+  public:
+    Compressor();
+    ~Compressor();
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    /**
+     * @brief Compress a complete body
+     * @param encoding The coding to apply; must not be Identity
+     * @param input The body
+     * @param out Receives the compressed body, replacing its contents
+     * @param level Level in the codec's scale, or -1 for the default
+     * @return False if the coding is unavailable or failed
+     */
+    bool compress(ContentEncoding encoding, std::string_view input, std::string& out,
+                  int level = -1);
+
+    /**
+     * @brief Start a stream, ending any stream that was not finished
+     * @return False if the coding is unavailable or failed
+     */
+    bool begin(ContentEncoding encoding, int level = -1);
+
+    /**
+     * @brief Compress the next part of a stream and flush it so the client can decode it
+     * @param input The next part of the body, may be empty
+     * @param out Receives the compressed bytes, appended
+     * @param finish True for the last part, which ends the stream
+     * @return False if there is no stream or the codec failed
+     */
+    bool write(std::string_view input, std::string& out, bool finish = false);
+
+    /**
+     * @brief Get the compressor of the calling thread
+     */
+    static Compressor& local();
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace boson
+
+#endif
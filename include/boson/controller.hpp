@@ -1,6 +1,7 @@
 #ifndef BOSON_CONTROLLER_HPP
 #define BOSON_CONTROLLER_HPP
 
+#include "http_method.hpp"
 #include "request.hpp"
 #include "response.hpp"
 #include "router.hpp"
@@ -14,20 +15,6 @@
 namespace boson
 {
 
-/**
- * @brief HTTP method types
- */
-enum class HttpMethod
-{
-    GET,
-    POST,
-    PUT,
-    DELETE,
-    PATCH,
-    OPTIONS,
-    HEAD
-};
-
 /**
  * @brief Route decorator information
  */
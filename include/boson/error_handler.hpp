@@ -72,6 +72,30 @@ class NotFoundError : public HttpError
     explicit NotFoundError(const std::string& message);
 };
 
+/**
+ * @class MethodNotAllowedError
+ * @brief Error for 405 Method Not Allowed
+ */
+class MethodNotAllowedError : public HttpError
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param message The error message
+     * @param allow Methods the resource supports, as sent in the Allow header
+     */
+    MethodNotAllowedError(const std::string& message, const std::string& allow);
+
+    /**
+     * @brief Get the methods the resource supports
+     * @return Comma-separated method names
+     */
+    const std::string& allow() const;
+
+  private:
+    std::string allowedMethods;
+};
+
 /**
  * @brief Error handler function type
  * @param err The error
@@ -0,0 +1,63 @@
+#ifndef BOSON_FILE_WATCHER_HPP
+#define BOSON_FILE_WATCHER_HPP
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+namespace boson
+{
+
+/**
+ * @class FileWatcher
+ * @brief Reports changes to files in watched directories from a background thread
+ *
+ * Uses inotify on Linux, so noticing a change costs nothing on the request path. Elsewhere
+ * supported() is false and watch() fails, and callers fall back to not caching.
+ */
+class FileWatcher
+{
+  public:
+    /**
+     * @brief Called on the watcher's thread for each change
+     *
+     * The path is the file or directory that was written, created, removed, renamed or had
+     * its attributes changed. When a directory is reported, anything below it may have
+     * changed; this is also how a watched directory reports that it was removed or that
+     * events were lost.
+     */
+    using Callback = std::function<void(const std::filesystem::path& path, bool directory)>;
+
+    FileWatcher();
+
+    /**
+     * @brief Stop watching and join the watcher's thread
+     */
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * @brief Check whether this platform can watch files
+     */
+    static bool supported();
+
+    /**
+     * @brief Start watching a directory, starting the watcher's thread on first use
+     * @param directory The directory
+     * @param recursive Also watch its subdirectories, including ones created later
+     * @param callback Called for every change; must not call back into this watcher
+     * @return False if the platform cannot watch files or the directory cannot be watched,
+     *         e.g. because the inotify watch limit was reached
+     */
+    bool watch(const std::filesystem::path& directory, bool recursive, Callback callback);
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace boson
+
+#endif
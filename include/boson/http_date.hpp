@@ -0,0 +1,41 @@
+#ifndef BOSON_HTTP_DATE_HPP
+#define BOSON_HTTP_DATE_HPP
+
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <string_view>
+
+namespace boson
+{
+
+/// Length of an IMF-fixdate such as "Sun, 06 Nov 1994 08:49:37 GMT"
+constexpr size_t kHttpDateLength = 29;
+
+/**
+ * @brief Format a time as an HTTP date (IMF-fixdate), independent of the locale
+ * @param time Seconds since the epoch
+ * @param out Receives exactly kHttpDateLength characters, not NUL-terminated
+ */
+void formatHttpDate(std::time_t time, char* out);
+
+/**
+ * @brief Format a file modification time as an HTTP date
+ * @param time A time from std::filesystem::last_write_time()
+ * @param out Receives exactly kHttpDateLength characters, not NUL-terminated
+ */
+void formatHttpDate(std::filesystem::file_time_type time, char* out);
+
+/**
+ * @brief Get the current time as an HTTP date
+ *
+ * Each thread keeps its own copy and formats it again only when the second changes, so
+ * calling this for every response costs a clock read.
+ *
+ * @return View valid until the calling thread's next call
+ */
+std::string_view currentHttpDate();
+
+} // namespace boson
+
+#endif
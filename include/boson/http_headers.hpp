@@ -0,0 +1,213 @@
+#ifndef BOSON_HTTP_HEADERS_HPP
+#define BOSON_HTTP_HEADERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace boson
+{
+
+/**
+ * @brief Headers the framework and typical handlers look up on every request
+ *
+ * Each one has a precomputed slot, so finding it does not compare names.
+ */
+enum class KnownHeader
+{
+    Accept,
+    AcceptEncoding,
+    Authorization,
+    CacheControl,
+    Connection,
+    ContentEncoding,
+    ContentLength,
+    ContentType,
+    Cookie,
+    Date,
+    ETag,
+    Host,
+    IfModifiedSince,
+    IfNoneMatch,
+    LastModified,
+    Server,
+    TransferEncoding,
+    UserAgent,
+    Vary,
+    Unknown ///< Any other header name
+};
+
+/// Number of KnownHeader values other than Unknown, for tables indexed by header
+constexpr size_t kKnownHeaderCount = static_cast<size_t>(KnownHeader::Unknown);
+
+/**
+ * @brief Identify a well-known header name
+ * @param name The header name, in any case
+ * @return The header, or KnownHeader::Unknown
+ */
+KnownHeader knownHeaderFromName(std::string_view name);
+
+/**
+ * @brief Get the canonical spelling of a well-known header
+ * @param header The header
+ * @return The name, or an empty view for KnownHeader::Unknown
+ */
+std::string_view knownHeaderName(KnownHeader header);
+
+/**
+ * @brief Compare two header names ignoring ASCII case
+ */
+bool headerNameEquals(std::string_view a, std::string_view b);
+
+/**
+ * @class HeaderList
+ * @brief Headers kept in insertion order in a flat vector, matched without regard to case
+ *
+ * Well-known headers are found through a slot table in constant time; other names are found
+ * by a scan, which is faster than a map for the handful of headers a message carries.
+ */
+class HeaderList
+{
+  public:
+    /**
+     * @brief One header; allocator-aware so its strings share the list's memory resource
+     */
+    struct Entry
+    {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        explicit Entry(const allocator_type& allocator = {}) : name(allocator), value(allocator)
+        {
+        }
+        Entry(const Entry& other, const allocator_type& allocator = {})
+            : name(other.name, allocator), value(other.value, allocator)
+        {
+        }
+        Entry(Entry&& other, const allocator_type& allocator)
+            : name(std::move(other.name), allocator), value(std::move(other.value), allocator)
+        {
+        }
+        Entry(Entry&& other) noexcept = default;
+        Entry& operator=(const Entry& other) = default;
+        Entry& operator=(Entry&& other) = default;
+
+        std::pmr::string name;
+        std::pmr::string value;
+    };
+
+    using const_iterator = std::pmr::vector<Entry>::const_iterator;
+
+    /**
+     * @brief Constructor
+     * @param memory Resource for the entries
+     */
+    explicit HeaderList(std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+    /**
+     * @brief Set a header, replacing the value of an existing one with the same name
+     *
+     * A replaced header keeps its position; a new one is appended.
+     *
+     * @param name The header name
+     * @param value The header value
+     */
+    void set(std::string_view name, std::string_view value);
+
+    /**
+     * @brief Set a well-known header
+     * @param header The header
+     * @param value The header value
+     */
+    void set(KnownHeader header, std::string_view value);
+
+    /**
+     * @brief Find a header
+     * @param name The header name, in any case
+     * @return The value, or nullptr if the header is not set
+     */
+    const std::pmr::string* find(std::string_view name) const;
+
+    /**
+     * @brief Find a well-known header
+     * @param header The header
+     * @return The value, or nullptr if the header is not set
+     */
+    const std::pmr::string* find(KnownHeader header) const;
+
+    /**
+     * @brief Check whether a header is set
+     */
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+    /**
+     * @brief Check whether a well-known header is set
+     */
+    bool contains(KnownHeader header) const { return find(header) != nullptr; }
+
+    /**
+     * @brief Remove a header
+     * @param name The header name, in any case
+     * @return True if it was set
+     */
+    bool erase(std::string_view name);
+
+    /**
+     * @brief Remove all headers, keeping the entry storage
+     */
+    void clear();
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+
+  private:
+    static constexpr uint32_t kNoEntry = UINT32_MAX;
+
+    long indexOf(std::string_view name, KnownHeader header) const;
+    void assign(std::string_view name, KnownHeader header, std::string_view value);
+    void reindex();
+
+    std::pmr::vector<Entry> entries_;
+    std::array<uint32_t, kKnownHeaderCount> known_;
+};
+
+/**
+ * @class HeaderBlock
+ * @brief Headers sent with every response, kept serialized so writing them is a single copy
+ */
+class HeaderBlock
+{
+  public:
+    /**
+     * @brief Add a header, replacing one with the same name
+     * @param name The header name
+     * @param value The header value
+     */
+    void set(std::string_view name, std::string_view value);
+
+    /**
+     * @brief Get the headers
+     */
+    const HeaderList& headers() const { return headers_; }
+
+    /**
+     * @brief Get the headers as "Name: value\r\n" lines, in the order they were added
+     */
+    std::string_view bytes() const { return bytes_; }
+
+    bool empty() const { return headers_.empty(); }
+
+  private:
+    HeaderList headers_;
+    std::string bytes_;
+};
+
+} // namespace boson
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef BOSON_HTTP_METHOD_HPP
+#define BOSON_HTTP_METHOD_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace boson
+{
+
+/**
+ * @brief HTTP method types
+ */
+enum class HttpMethod
+{
+    GET,
+    POST,
+    PUT,
+    DELETE,
+    PATCH,
+    OPTIONS,
+    HEAD,
+    CONNECT,
+    TRACE,
+    UNKNOWN ///< Any other method token
+};
+
+/// Number of HttpMethod values, for tables indexed by method
+constexpr size_t kHttpMethodCount = static_cast<size_t>(HttpMethod::UNKNOWN) + 1;
+
+/**
+ * @brief Look up the method for a request-line token
+ * @param name The method token, which is case-sensitive
+ * @return The method, or HttpMethod::UNKNOWN for extension methods
+ */
+HttpMethod httpMethodFromString(std::string_view name);
+
+/**
+ * @brief Get the token for a method
+ * @param method The method
+ * @return The method name, or an empty view for HttpMethod::UNKNOWN
+ */
+std::string_view httpMethodName(HttpMethod method);
+
+} // namespace boson
+
+#endif
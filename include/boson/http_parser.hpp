@@ -0,0 +1,171 @@
+#ifndef BOSON_HTTP_PARSER_HPP
+#define BOSON_HTTP_PARSER_HPP
+
+#include "http_method.hpp"
+#include <cstddef>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace boson
+{
+
+/**
+ * @struct HttpSpan
+ * @brief Position of a token relative to the start of the message
+ */
+struct HttpSpan
+{
+    size_t offset = 0;
+    size_t length = 0;
+
+    /**
+     * @brief Resolve the span against the message it was parsed from
+     * @param message Start of the message
+     * @return View of the token
+     */
+    std::string_view in(const char* message) const
+    {
+        return std::string_view(message + offset, length);
+    }
+};
+
+/**
+ * @struct HttpHeaderField
+ * @brief Name and value positions of one header line
+ */
+struct HttpHeaderField
+{
+    HttpSpan name;
+    HttpSpan value;
+};
+
+/**
+ * @enum ScanKernel
+ * @brief Implementation used to search for line ends and header delimiters
+ */
+enum class ScanKernel
+{
+    Scalar, ///< Portable byte-at-a-time loops
+    Sse42,  ///< 16 bytes per step with SSE4.2 string instructions
+    Avx2    ///< 32 bytes per step with AVX2 compares
+};
+
+/**
+ * @class HttpParser
+ * @brief Resumable HTTP/1.x request parser that records token positions instead of copying
+ *
+ * Feed it everything received so far for one message. Each call continues where the previous
+ * one stopped, so bytes are examined once however the request is split across reads, and the
+ * buffer may be reallocated between calls because only offsets are kept.
+ */
+class HttpParser
+{
+  public:
+    enum class Status
+    {
+        Incomplete,      ///< More bytes are needed
+        Complete,        ///< Headers and body have been received
+        Invalid,         ///< Malformed request
+        Unsupported,     ///< Body sent with Transfer-Encoding, which is not decoded
+        HeadersTooLarge, ///< Request line and header block exceed maxHeaderSize
+        BodyTooLarge     ///< Content-Length exceeds maxBodySize
+    };
+
+    /**
+     * @brief Constructor
+     * @param maxHeaderSize Largest accepted request line plus header block, in bytes
+     * @param maxBodySize Largest accepted Content-Length, in bytes
+     */
+    explicit HttpParser(size_t maxHeaderSize = 65536,
+                        size_t maxBodySize = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief Continue parsing the message
+     * @param message Start of the message
+     * @param length Number of bytes of the message received so far
+     * @return The parse status; after anything but Incomplete or Complete the message must be
+     *         discarded
+     */
+    Status parse(const char* message, size_t length);
+
+    /**
+     * @brief Forget the current message so the parser can start on the next one
+     */
+    void reset();
+
+    /**
+     * @brief Get the scanning kernel picked for this CPU at startup
+     */
+    static ScanKernel scanKernel();
+
+    /**
+     * @brief Force a scanning kernel for all parsers, e.g. to compare them in a benchmark
+     * @param kernel The kernel to use
+     * @return False if the CPU or the build does not support it
+     */
+    static bool setScanKernel(ScanKernel kernel);
+
+    HttpSpan method() const { return method_; }
+    HttpMethod methodType() const { return methodType_; }
+    HttpSpan target() const { return target_; }
+    HttpSpan path() const { return path_; }
+    HttpSpan query() const { return query_; }
+    HttpSpan version() const { return version_; }
+    HttpSpan body() const { return HttpSpan{headerLength_, contentLength_}; }
+    const std::vector<HttpHeaderField>& headers() const { return headers_; }
+
+    /**
+     * @brief Get the length of the request line and header block, including the blank line
+     */
+    size_t headerLength() const { return headerLength_; }
+
+    /**
+     * @brief Get the length of the whole message once parse() returned Complete
+     */
+    size_t messageLength() const { return headerLength_ + contentLength_; }
+
+  private:
+    enum class State
+    {
+        RequestLineStart,
+        Method,
+        Target,
+        Version,
+        RequestLineEnd,
+        HeaderLineStart,
+        HeaderName,
+        HeaderValueStart,
+        HeaderValue,
+        HeaderLineEnd,
+        HeadersEnd,
+        Body,
+        Done
+    };
+
+    /**
+     * @brief Work out the body length once the header block has ended
+     * @return Incomplete to go on with the body, or the status that refuses it
+     */
+    Status finishHeaders(const char* message);
+
+    size_t maxHeaderSize_;
+    size_t maxBodySize_;
+    State state_ = State::RequestLineStart;
+    size_t position_ = 0;
+    size_t tokenStart_ = 0;
+    HttpSpan method_;
+    HttpMethod methodType_ = HttpMethod::UNKNOWN;
+    HttpSpan target_;
+    HttpSpan path_;
+    HttpSpan query_;
+    HttpSpan version_;
+    HttpHeaderField field_;
+    std::vector<HttpHeaderField> headers_;
+    size_t headerLength_ = 0;
+    size_t contentLength_ = 0;
+};
+
+} // namespace boson
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef BOSON_HTTP_STATUS_HPP
+#define BOSON_HTTP_STATUS_HPP
+
+#include <string_view>
+
+namespace boson
+{
+
+/**
+ * @brief Get the complete status line for a status code
+ * @param code The status code
+ * @return "HTTP/1.1 NNN Reason\r\n", or an empty view for a code without a registered reason
+ */
+std::string_view statusLine(int code);
+
+/**
+ * @brief Get the reason phrase for a status code
+ * @param code The status code
+ * @return The reason phrase, or "Unknown" for an unregistered code
+ */
+std::string_view statusText(int code);
+
+} // namespace boson
+
+#endif
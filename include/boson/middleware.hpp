@@ -1,9 +1,12 @@
 #ifndef BOSON_MIDDLEWARE_HPP
 #define BOSON_MIDDLEWARE_HPP
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 
@@ -62,9 +65,76 @@ class NextFunction
      */
     bool hasNext() const;
 
+    /**
+     * @brief Run middleware in order, each reaching the next one through its NextFunction
+     *
+     * Every layer gets its NextFunction on the stack, so dispatch does not allocate. Code after
+     * next() in a middleware runs once the layers after it have returned.
+     *
+     * @param chain The middleware to run
+     * @param count Number of entries in chain
+     * @param req The HTTP request
+     * @param res The HTTP response
+     * @return True if the last middleware called next() and no response has been sent
+     */
+    static bool run(const Middleware* const* chain, size_t count, const Request& req,
+                    Response& res);
+
   private:
-    class Impl;
-    std::unique_ptr<Impl> pimpl;
+    // Kept inline rather than behind a pimpl: one is created per middleware layer per request
+    Middleware nextMiddleware_;
+    std::string error_;
+    const Request* request_;
+    Response* response_;
+    const Middleware* const* chain_; ///< Middleware from this layer on, when driven by run()
+    size_t remaining_;
+    bool* completed_;
+};
+
+/**
+ * @class MiddlewareSelection
+ * @brief Middleware picked for one request, held on the stack unless the chain is long
+ */
+class MiddlewareSelection
+{
+  public:
+    /**
+     * @brief Append middleware, which must outlive the selection
+     * @param middleware The middleware to run next
+     */
+    void add(const Middleware& middleware)
+    {
+        if (size_ < inline_.size())
+        {
+            inline_[size_] = &middleware;
+        }
+        else
+        {
+            if (overflow_.empty())
+            {
+                overflow_.assign(inline_.begin(), inline_.end());
+            }
+            overflow_.push_back(&middleware);
+        }
+        size_++;
+    }
+
+    /**
+     * @brief Run the selected middleware
+     * @return True if the last middleware called next() and no response has been sent
+     */
+    bool run(const Request& req, Response& res) const
+    {
+        return NextFunction::run(size_ <= inline_.size() ? inline_.data() : overflow_.data(),
+                                 size_, req, res);
+    }
+
+    size_t size() const { return size_; }
+
+  private:
+    std::array<const Middleware*, 16> inline_;
+    std::vector<const Middleware*> overflow_;
+    size_t size_ = 0;
 };
 
 /**
@@ -97,8 +167,16 @@ class MiddlewareChain
     
     /**
      * @brief Add middleware to the chain for a specific path
+     *
+     * A plain path such as "/api" matches itself and everything below it. A trailing '*'
+     * ("/api*") matches any path starting with the text before it. Any other '*' matches within
+     * one segment ("/img/icon-*.png") and "**" matches across segments. Patterns using regex
+     * syntax are compiled once here, except that an anchored literal such as "^/health$" is
+     * matched exactly.
+     *
      * @param path The path pattern to match
      * @param middleware The middleware to add
+     * @throws std::invalid_argument if the pattern is not a valid regular expression
      */
     void add(const std::string& path, const Middleware& middleware);
 
@@ -112,6 +190,9 @@ class MiddlewareChain
     
     /**
      * @brief Check if path pattern matches the request path
+     *
+     * Compiles the pattern on every call; the chain itself compiles patterns once in add().
+     *
      * @param pattern The path pattern
      * @param path The request path
      * @return True if pattern matches path, false otherwise
@@ -119,7 +200,41 @@ class MiddlewareChain
     static bool pathMatches(const std::string& pattern, const std::string& path);
 
   private:
+    /**
+     * @brief Pattern that needs evaluating per request because it is a glob or a regex
+     */
+    struct PatternMatcher
+    {
+        size_t entry;
+        std::string glob;                        ///< Set for glob patterns
+        std::shared_ptr<const std::regex> regex; ///< Set for regex patterns
+    };
+
+    /**
+     * @brief Character trie node for literal path patterns
+     */
+    struct PrefixNode
+    {
+        std::vector<std::pair<char, size_t>> children;
+        std::vector<size_t> anyEntries;     ///< Raw prefixes ("/api*") and unscoped middleware
+        std::vector<size_t> segmentEntries; ///< Paths matching at a segment boundary ("/api")
+        std::vector<size_t> exactEntries;   ///< Anchored literal paths ("^/health$")
+    };
+
     std::vector<MiddlewareEntry> chain;
+    std::vector<PrefixNode> prefixNodes{PrefixNode()};
+    std::vector<PatternMatcher> patternMatchers;
+
+    /**
+     * @brief Compile an entry's path into the prefix trie or the pattern matcher list
+     * @param entry Index of the entry in chain
+     */
+    void compile(size_t entry);
+
+    /**
+     * @brief Get the trie node for a literal, creating it if needed
+     */
+    size_t prefixNode(std::string_view literal);
 };
 
 } // namespace boson
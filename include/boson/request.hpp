@@ -2,10 +2,14 @@
 #define BOSON_REQUEST_HPP
 
 #include "../external/json.hpp"
+#include "http_headers.hpp"
+#include "http_parser.hpp"
 #include <any>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 
@@ -35,6 +39,14 @@ class Request
 {
   public:
     Request();
+
+    /**
+     * @brief Constructor
+     * @param memory Resource for the request's state and containers, e.g. a RequestArena;
+     * it must outlive the request
+     */
+    explicit Request(std::pmr::memory_resource* memory);
+
     ~Request();
 
     /**
@@ -43,12 +55,42 @@ class Request
      */
     std::string method() const;
 
+    /**
+     * @brief Get the HTTP method without copying it
+     * @return View valid for the lifetime of the request
+     */
+    std::string_view methodView() const;
+
+    /**
+     * @brief Get the HTTP method as parsed from the request line
+     * @return The method, or HttpMethod::UNKNOWN for extension methods
+     */
+    HttpMethod methodType() const;
+
     /**
      * @brief Get the request path
      * @return The request path
      */
     std::string path() const;
 
+    /**
+     * @brief Get the request path without copying it
+     * @return View valid until the path is overridden or the request is destroyed
+     */
+    std::string_view pathView() const;
+
+    /**
+     * @brief Get the HTTP version from the request line
+     * @return The HTTP version (e.g. "HTTP/1.1")
+     */
+    std::string httpVersion() const;
+
+    /**
+     * @brief Get the HTTP version without copying it
+     * @return View valid for the lifetime of the request
+     */
+    std::string_view httpVersionView() const;
+
     /**
      * @brief Get the query string
      * @return The query string
@@ -56,7 +98,17 @@ class Request
     std::string queryString() const;
 
     /**
-     * @brief Get a specific query parameter
+     * @brief Get the query string without copying it
+     * @return View valid for the lifetime of the request
+     */
+    std::string_view queryStringView() const;
+
+    /**
+     * @brief Get a specific query parameter or multipart form field
+     *
+     * The query string and any multipart/form-data body are parsed on the first call to
+     * query(), queryParams() or files(), not for requests whose handlers never read them.
+     *
      * @param name The name of the query parameter
      * @return The value of the query parameter
      */
@@ -75,19 +127,61 @@ class Request
      */
     std::string param(const std::string& name) const;
 
+    /**
+     * @brief Get a route parameter without copying it
+     * @param name The name of the route parameter
+     * @return View of the value, or an empty view if there is no such parameter
+     */
+    std::string_view paramView(std::string_view name) const;
+
+    /**
+     * @brief Get a route parameter converted straight from the path
+     * @tparam T An integer or floating-point type, bool, std::string or std::string_view
+     * @param name The name of the route parameter
+     * @return The converted value
+     * @throws BadRequestError if the parameter is missing or not a valid T
+     */
+    template <typename T> T param(std::string_view name) const;
+
+    /**
+     * @brief Get a route parameter converted straight from the path, or a fallback
+     * @tparam T An integer or floating-point type, bool, std::string or std::string_view
+     * @param name The name of the route parameter
+     * @param fallback Value returned if the parameter is missing or not a valid T
+     * @return The converted value or the fallback
+     */
+    template <typename T> T param(std::string_view name, T fallback) const;
+
     /**
      * @brief Get all route parameters
+     *
+     * Builds a map on every call; param() and paramView() read the parameters in place.
+     *
      * @return A map of route parameters
      */
     std::map<std::string, std::string> params() const;
 
     /**
      * @brief Get a specific header
-     * @param name The name of the header
+     * @param name The name of the header (case-insensitive)
      * @return The value of the header
      */
     std::string header(const std::string& name) const;
 
+    /**
+     * @brief Get a specific header without copying it
+     * @param name The name of the header (case-insensitive)
+     * @return View of the value, empty if the header is absent
+     */
+    std::string_view headerView(std::string_view name) const;
+
+    /**
+     * @brief Get a well-known header without comparing names
+     * @param header The header
+     * @return View of the value, empty if the header is absent
+     */
+    std::string_view headerView(KnownHeader header) const;
+
     /**
      * @brief Get all headers
      * @return A map of headers
@@ -100,6 +194,12 @@ class Request
      */
     std::string body() const;
 
+    /**
+     * @brief Get the request body without copying it
+     * @return View valid until setBody() is called or the request is destroyed
+     */
+    std::string_view bodyView() const;
+
     /**
      * @brief Set the request body directly
      * @param body The raw request body
@@ -165,6 +265,9 @@ class Request
     
     /**
      * @brief Get a cookie value by name
+     *
+     * The Cookie header is parsed on the first call to cookie() or cookies().
+     *
      * @param name The name of the cookie
      * @return The cookie value or empty string if not found
      */
@@ -182,6 +285,13 @@ class Request
      */
     void setRawRequest(const std::string& rawRequest);
 
+    /**
+     * @brief Adopt a request that has already been parsed, without copying it
+     * @param rawRequest The complete message; must outlive the request
+     * @param parser Parser that returned Complete for rawRequest
+     */
+    void setParsedRequest(std::string_view rawRequest, const HttpParser& parser);
+
     /**
      * @brief Set a route parameter
      * @param name The name of the parameter
@@ -189,6 +299,13 @@ class Request
      */
     void setRouteParam(const std::string& name, const std::string& value);
 
+    /**
+     * @brief Record a route parameter without copying it (for internal routing use)
+     * @param name The name of the parameter; must outlive the request
+     * @param value The value, usually a view into the request path; must outlive the request
+     */
+    void addRouteParam(std::string_view name, std::string_view value);
+
     /**
      * @brief Set the original request path (for internal routing use)
      * @param path The original path
@@ -201,11 +318,28 @@ class Request
      */
     void overridePath(const std::string& path);
 
+    /**
+     * @brief Record the mount point of the route that matched (for internal routing use)
+     *
+     * path() and pathView() are then the part of the path below it. The path itself is not
+     * changed, so originalUrl() stays the full URL.
+     *
+     * @param prefixLength Length of the mount path to hide, or 0 for the full path
+     */
+    void setMountPrefix(size_t prefixLength);
+
     /**
      * @brief Parse the raw HTTP request
      */
     void parse();
 
+    /**
+     * @brief Return to the state of a newly constructed request so it can be reused
+     *
+     * Header lists and buffers keep their capacity, except buffers larger than 64 KB.
+     */
+    void reset();
+
     /**
      * @brief Get uploaded files (multipart/form-data)
      * @return Vector of UploadedFile
@@ -214,7 +348,16 @@ class Request
 
   private:
     class Impl;
-    std::unique_ptr<Impl> pimpl;
+
+    /**
+     * @brief Destroys the Impl and returns it to the memory resource it came from
+     */
+    struct ImplDeleter
+    {
+        void operator()(Impl* impl) const;
+    };
+
+    std::unique_ptr<Impl, ImplDeleter> pimpl;
 };
 
 } // namespace boson
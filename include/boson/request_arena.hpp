@@ -0,0 +1,126 @@
+#ifndef BOSON_REQUEST_ARENA_HPP
+#define BOSON_REQUEST_ARENA_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace boson
+{
+
+/**
+ * @brief Orders strings through std::string_view, so maps keyed by std::pmr::string can be
+ * searched with std::string, std::string_view or string literal keys
+ */
+struct StringViewLess
+{
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const { return a < b; }
+};
+
+/// String map whose nodes and strings come from a memory resource, e.g. a RequestArena
+using ArenaStringMap = std::pmr::map<std::pmr::string, std::pmr::string, StringViewLess>;
+
+/**
+ * @class RequestArena
+ * @brief Monotonic memory for everything one request allocates, released in one step
+ *
+ * Request and Response objects built on it place their state and containers in it, so they
+ * take memory by bumping a pointer through a buffer that is reused after reset(), instead of
+ * going through the global allocator that all threads share. Allocations that outgrow the
+ * buffer take further blocks from the heap until reset(). The server itself reuses its
+ * objects through a RequestPool; an arena suits objects built outside it.
+ */
+class RequestArena
+{
+  public:
+    /// Size of the buffer reused by every request, which covers typical requests
+    static constexpr size_t kDefaultCapacity = 16 * 1024;
+
+    /**
+     * @brief Constructor
+     * @param capacity Size of the reusable buffer in bytes
+     */
+    explicit RequestArena(size_t capacity = kDefaultCapacity);
+    ~RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /**
+     * @brief Get the memory resource to allocate request-scoped objects from
+     */
+    std::pmr::memory_resource* resource() { return &memory_; }
+
+    /**
+     * @brief Release everything allocated since the last reset
+     *
+     * Every object using the arena must have been destroyed.
+     */
+    void reset();
+
+    /**
+     * @class Scope
+     * @brief Resets an arena when it goes out of scope
+     *
+     * Declare it before the objects that use the arena so they are destroyed first.
+     */
+    class Scope
+    {
+      public:
+        explicit Scope(RequestArena& arena) : arena_(arena) {}
+        ~Scope() { arena_.reset(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        RequestArena& arena_;
+    };
+
+  private:
+    std::unique_ptr<std::byte[]> buffer_;
+    std::pmr::monotonic_buffer_resource memory_;
+};
+
+/**
+ * @brief Set a map entry, allocating a new key and value from the map's memory resource
+ * @param map The map to update
+ * @param key The entry's key
+ * @param value The entry's new value
+ * @return Iterator to the entry
+ */
+inline ArenaStringMap::iterator putString(ArenaStringMap& map, std::string_view key,
+                                          std::string_view value)
+{
+    auto it = map.find(key);
+    if (it == map.end())
+    {
+        return map.emplace(key, value).first;
+    }
+    it->second.assign(value.data(), value.size());
+    return it;
+}
+
+/**
+ * @brief Copy a string map from a memory resource into an ordinary std::map
+ * @param map The map to copy
+ * @return A map that does not refer to the memory resource
+ */
+inline std::map<std::string, std::string> toStdMap(const ArenaStringMap& map)
+{
+    std::map<std::string, std::string> result;
+    for (const auto& entry : map)
+    {
+        result.emplace_hint(result.end(), std::string(entry.first), std::string(entry.second));
+    }
+    return result;
+}
+
+} // namespace boson
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef BOSON_REQUEST_POOL_HPP
+#define BOSON_REQUEST_POOL_HPP
+
+#include "request.hpp"
+#include "response.hpp"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace boson
+{
+
+/**
+ * @brief Empty a string or vector, keeping its buffer for the next request unless it is large
+ * @param container The container to clear
+ * @param maxRetainedBytes Buffers bigger than this are released rather than kept
+ */
+template <typename Container>
+void clearRetaining(Container& container, size_t maxRetainedBytes)
+{
+    container.clear();
+    if (container.capacity() * sizeof(typename Container::value_type) > maxRetainedBytes)
+    {
+        container.shrink_to_fit();
+    }
+}
+
+/**
+ * @class RequestPool
+ * @brief Request and Response objects reused across the requests served by one thread
+ *
+ * Objects handed back are reset() rather than destroyed, so their header lists, body buffers
+ * and cookie lists keep their capacity, and map nodes return to the pool's memory resource to
+ * be reused. Once a keep-alive connection is warm, serving a request makes no calls to the
+ * global allocator.
+ */
+class RequestPool
+{
+  public:
+    /**
+     * @class Lease
+     * @brief A request and response taken from a pool, returned when the lease is destroyed
+     */
+    class Lease
+    {
+      public:
+        Lease(RequestPool& pool, std::unique_ptr<Request> request,
+              std::unique_ptr<Response> response);
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Request& request() { return *request_; }
+        Response& response() { return *response_; }
+
+      private:
+        RequestPool& pool_;
+        std::unique_ptr<Request> request_;
+        std::unique_ptr<Response> response_;
+    };
+
+    RequestPool();
+    ~RequestPool();
+
+    RequestPool(const RequestPool&) = delete;
+    RequestPool& operator=(const RequestPool&) = delete;
+
+    /**
+     * @brief Take a reset request and response, creating them if none are free
+     */
+    Lease acquire();
+
+    /**
+     * @brief Get the pool of the calling thread
+     */
+    static RequestPool& local();
+
+  private:
+    // Declared first so the pooled objects are destroyed before the memory they use
+    std::pmr::unsynchronized_pool_resource memory_;
+    std::vector<std::unique_ptr<Request>> requests_;
+    std::vector<std::unique_ptr<Response>> responses_;
+};
+
+} // namespace boson
+
+#endif
@@ -2,12 +2,17 @@
 #define BOSON_RESPONSE_HPP
 
 #include "../external/json.hpp"
+#include "compression.hpp"
 #include "cookie.hpp"
+#include "http_headers.hpp"
 #include <any>
+#include <cstdint>
 #include <initializer_list>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <fstream>
@@ -16,6 +21,18 @@
 namespace boson
 {
 
+/**
+ * @struct FileBody
+ * @brief File region that the server transmits straight from the page cache
+ */
+struct FileBody
+{
+    int fd = -1;              ///< Open descriptor owned by the response
+    std::uint64_t offset = 0; ///< First byte of the region
+    std::uint64_t length = 0; ///< Number of bytes to send
+    bool chunked = false;     ///< Send as a single chunk of a chunked-encoded body
+};
+
 /**
  * @class Response
  * @brief Represents an HTTP response
@@ -24,6 +41,14 @@ class Response
 {
   public:
     Response();
+
+    /**
+     * @brief Constructor
+     * @param memory Resource for the response's state and containers, e.g. a RequestArena;
+     * it must outlive the response
+     */
+    explicit Response(std::pmr::memory_resource* memory);
+
     ~Response();
 
     /**
@@ -33,6 +58,17 @@ class Response
      */
     Response& send(const std::string& body);
 
+    /**
+     * @brief Send a body that is shared rather than copied into the response
+     *
+     * The response holds a reference until it is reset, so the owner may drop or replace
+     * its copy meanwhile. A shared body is sent as is and never compressed.
+     *
+     * @param body The body to send
+     * @return Reference to this response for method chaining
+     */
+    Response& sendShared(std::shared_ptr<const std::string> body);
+
     /**
      * @brief Send a JSON response
      * @param json The JSON data to send (as std::any)
@@ -110,12 +146,33 @@ class Response
     Response& end();
 
     /**
-     * @brief Enable/disable compression for the response
-     * @param enable Whether to enable compression
+     * @brief Force compression of this response on or off
+     *
+     * The body is compressed with the best coding the request's Accept-Encoding allows when
+     * the response is sent, buffered or streamed. Forcing it on skips the server's
+     * content-type allowlist but not the minimum size; without a call, the server's
+     * automatic compression decides (see Server::setCompression()).
+     *
+     * @param enable Whether to compress
      * @return Reference to this response for method chaining
      */
     Response& compress(bool enable = true);
 
+    /**
+     * @brief Tell the response what the client accepts, before the handler runs
+     * @param acceptEncoding The request's Accept-Encoding header; must outlive the response's
+     *                       use of it
+     * @param automatic Options for compressing responses that did not call compress(), or
+     *                  nullptr to compress only those that did
+     */
+    void setCompressionContext(std::string_view acceptEncoding,
+                               const CompressionOptions* automatic);
+
+    /**
+     * @brief Compress the buffered body if it qualifies, before the head is written
+     */
+    void applyCompression();
+
     /**
      * @brief Set the status code
      * @param code The status code
@@ -124,13 +181,21 @@ class Response
     Response& status(int code);
 
     /**
-     * @brief Set a header
+     * @brief Set a header, replacing one with the same name in any case
      * @param name The name of the header
      * @param value The value of the header
      * @return Reference to this response for method chaining
      */
     Response& header(const std::string& name, const std::string& value);
 
+    /**
+     * @brief Set a well-known header without building its name
+     * @param header The header
+     * @param value The value of the header
+     * @return Reference to this response for method chaining
+     */
+    Response& header(KnownHeader header, std::string_view value);
+
     /**
      * @brief Set multiple headers
      * @param headers The headers to set
@@ -200,6 +265,13 @@ class Response
      */
     bool sent() const;
 
+    /**
+     * @brief Return to the state of a newly constructed response so it can be reused
+     *
+     * Closes any file body. Buffers keep their capacity, except buffers larger than 64 KB.
+     */
+    void reset();
+
     /**
      * @brief Get the raw HTTP response
      * @return The raw HTTP response
@@ -218,12 +290,79 @@ class Response
      */
     std::map<std::string, std::string> getHeaders() const;
 
+    /**
+     * @brief Get a single header
+     * @param name The name of the header (case-insensitive)
+     * @return The header value or empty string if not set
+     */
+    std::string getHeader(const std::string& name) const;
+
+    /**
+     * @brief Check whether a well-known header has been set
+     * @param header The header
+     * @return True if the header is set
+     */
+    bool hasHeader(KnownHeader header) const;
+
     /**
      * @brief Get the response body
-     * @return The response body
+     * @return The response body, read from disk if the body is a file
      */
     std::string getBody() const;
 
+    /**
+     * @brief Get the body without copying it
+     * @return View valid until the response is modified, empty if the body is a file
+     */
+    std::string_view getBodyView() const;
+
+    /**
+     * @brief Get the status line and headers, terminated by the blank line
+     * @return The serialized response head
+     */
+    std::string getRawHeaders() const;
+
+    /**
+     * @brief Serialize the response as buffers in wire order without copying the body
+     * @param segments Receives the head and the body; the views stay valid until the response
+     *                 is modified or destroyed. A file body is not included, see getFileBody()
+     */
+    void serialize(std::vector<std::string_view>& segments) const;
+
+    /**
+     * @brief Append the status line and headers, terminated by the blank line, to a buffer
+     *
+     * Date, Content-Type, Content-Length and Connection are filled in if the response has not
+     * set them; the response's own headers are not changed.
+     *
+     * @param out The buffer to append to, typically a connection's reusable output buffer
+     * @param defaults Headers to send unless the response sets the same name, or nullptr
+     */
+    void writeHead(std::string& out, const HeaderBlock* defaults = nullptr) const;
+
+    /**
+     * @brief Append the head of a response whose body is streamed with write()
+     *
+     * Like writeHead(), but no Content-Length or Content-Type is added, since neither is known
+     * before the body is.
+     *
+     * @param out The buffer to append to
+     * @param defaults Headers to send unless the response sets the same name, or nullptr
+     */
+    void writeStreamHead(std::string& out, const HeaderBlock* defaults = nullptr) const;
+
+    /**
+     * @brief Check if the body is a file region to be sent with sendfile(2)
+     * @return True if sendFile() or streamFile() attached a file body
+     */
+    bool hasFileBody() const;
+
+    /**
+     * @brief Get the file region attached by sendFile() or streamFile()
+     * @return The file body; fd is -1 when the response has none
+     */
+    FileBody getFileBody() const;
+
     /**
      * @brief Set the stream callback function for handling streaming responses
      * @param callback The callback function that takes a string chunk and sends it
@@ -231,9 +370,25 @@ class Response
      */
     Response& setStreamCallback(std::function<void(const std::string&)> callback);
 
+    /**
+     * @brief Check whether a streamed body has been terminated
+     * @return True once end() or streamFile() sent the last chunk; false if nothing was
+     *         streamed or the stream is still open
+     */
+    bool streamEnded() const;
+
   private:
     class Impl;
-    std::unique_ptr<Impl> pimpl;
+
+    /**
+     * @brief Destroys the Impl and returns it to the memory resource it came from
+     */
+    struct ImplDeleter
+    {
+        void operator()(Impl* impl) const;
+    };
+
+    std::unique_ptr<Impl, ImplDeleter> pimpl;
     
     /**
      * @brief Detect MIME type based on file extension
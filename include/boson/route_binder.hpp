@@ -2,6 +2,7 @@
 #define BOSON_ROUTE_BINDER_HPP
 
 #include "controller.hpp"
+#include "route_pattern.hpp"
 #include "router.hpp"
 #include "server.hpp"
 #include <functional>
@@ -31,7 +32,7 @@ template <typename ControllerT> class RouteBinder
      */
     template <typename F> RouteBinder& get(const std::string& path, F handler)
     {
-        registerHandler("GET", path, handler);
+        registerHandler(HttpMethod::GET, path, {}, handler);
         return *this;
     }
 
@@ -41,7 +42,7 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& get(const std::string& path, const Middleware& middleware, F handler)
     {
-        registerHandlerWithMiddleware("GET", path, {middleware}, handler);
+        registerHandler(HttpMethod::GET, path, {middleware}, handler);
         return *this;
     }
 
@@ -51,7 +52,55 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& get(const std::string& path, const std::vector<Middleware>& middlewares, F handler)
     {
-        registerHandlerWithMiddleware("GET", path, middlewares, handler);
+        registerHandler(HttpMethod::GET, path, middlewares, handler);
+        return *this;
+    }
+
+    /**
+     * @brief Register a GET route handler bound to a controller method at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @param path The route path; parsed by the compiler only if it is a constexpr pattern
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler>
+    RouteBinder& get(const RoutePattern& path, const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler>(HttpMethod::GET, path, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a GET route handler with middleware bound to a controller method at
+     * compile time
+     */
+    template <auto Handler>
+    RouteBinder& get(const RoutePattern& path, const Middleware& middleware)
+    {
+        bind<Handler>(HttpMethod::GET, path, {middleware});
+        return *this;
+    }
+
+    /**
+     * @brief Register a GET route handler whose pattern must be parsed at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @tparam Path A constexpr RoutePattern; anything else fails to compile
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& get(const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler, Path>(HttpMethod::GET, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a GET route handler with middleware whose pattern must be parsed at
+     * compile time
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& get(const Middleware& middleware)
+    {
+        bind<Handler, Path>(HttpMethod::GET, {middleware});
         return *this;
     }
 
@@ -60,7 +109,7 @@ template <typename ControllerT> class RouteBinder
      */
     template <typename F> RouteBinder& post(const std::string& path, F handler)
     {
-        registerHandler("POST", path, handler);
+        registerHandler(HttpMethod::POST, path, {}, handler);
         return *this;
     }
 
@@ -70,7 +119,7 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& post(const std::string& path, const Middleware& middleware, F handler)
     {
-        registerHandlerWithMiddleware("POST", path, {middleware}, handler);
+        registerHandler(HttpMethod::POST, path, {middleware}, handler);
         return *this;
     }
 
@@ -81,7 +130,55 @@ template <typename ControllerT> class RouteBinder
     RouteBinder& post(const std::string& path, const std::vector<Middleware>& middlewares,
                       F handler)
     {
-        registerHandlerWithMiddleware("POST", path, middlewares, handler);
+        registerHandler(HttpMethod::POST, path, middlewares, handler);
+        return *this;
+    }
+
+    /**
+     * @brief Register a POST route handler bound to a controller method at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @param path The route path; parsed by the compiler only if it is a constexpr pattern
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler>
+    RouteBinder& post(const RoutePattern& path, const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler>(HttpMethod::POST, path, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a POST route handler with middleware bound to a controller method at
+     * compile time
+     */
+    template <auto Handler>
+    RouteBinder& post(const RoutePattern& path, const Middleware& middleware)
+    {
+        bind<Handler>(HttpMethod::POST, path, {middleware});
+        return *this;
+    }
+
+    /**
+     * @brief Register a POST route handler whose pattern must be parsed at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @tparam Path A constexpr RoutePattern; anything else fails to compile
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& post(const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler, Path>(HttpMethod::POST, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a POST route handler with middleware whose pattern must be parsed at
+     * compile time
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& post(const Middleware& middleware)
+    {
+        bind<Handler, Path>(HttpMethod::POST, {middleware});
         return *this;
     }
 
@@ -90,7 +187,7 @@ template <typename ControllerT> class RouteBinder
      */
     template <typename F> RouteBinder& put(const std::string& path, F handler)
     {
-        registerHandler("PUT", path, handler);
+        registerHandler(HttpMethod::PUT, path, {}, handler);
         return *this;
     }
 
@@ -100,7 +197,7 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& put(const std::string& path, const Middleware& middleware, F handler)
     {
-        registerHandlerWithMiddleware("PUT", path, {middleware}, handler);
+        registerHandler(HttpMethod::PUT, path, {middleware}, handler);
         return *this;
     }
 
@@ -110,7 +207,55 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& put(const std::string& path, const std::vector<Middleware>& middlewares, F handler)
     {
-        registerHandlerWithMiddleware("PUT", path, middlewares, handler);
+        registerHandler(HttpMethod::PUT, path, middlewares, handler);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PUT route handler bound to a controller method at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @param path The route path; parsed by the compiler only if it is a constexpr pattern
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler>
+    RouteBinder& put(const RoutePattern& path, const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler>(HttpMethod::PUT, path, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PUT route handler with middleware bound to a controller method at
+     * compile time
+     */
+    template <auto Handler>
+    RouteBinder& put(const RoutePattern& path, const Middleware& middleware)
+    {
+        bind<Handler>(HttpMethod::PUT, path, {middleware});
+        return *this;
+    }
+
+    /**
+     * @brief Register a PUT route handler whose pattern must be parsed at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @tparam Path A constexpr RoutePattern; anything else fails to compile
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& put(const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler, Path>(HttpMethod::PUT, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PUT route handler with middleware whose pattern must be parsed at
+     * compile time
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& put(const Middleware& middleware)
+    {
+        bind<Handler, Path>(HttpMethod::PUT, {middleware});
         return *this;
     }
 
@@ -119,7 +264,7 @@ template <typename ControllerT> class RouteBinder
      */
     template <typename F> RouteBinder& del(const std::string& path, F handler)
     {
-        registerHandler("DELETE", path, handler);
+        registerHandler(HttpMethod::DELETE, path, {}, handler);
         return *this;
     }
 
@@ -129,7 +274,7 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& del(const std::string& path, const Middleware& middleware, F handler)
     {
-        registerHandlerWithMiddleware("DELETE", path, {middleware}, handler);
+        registerHandler(HttpMethod::DELETE, path, {middleware}, handler);
         return *this;
     }
 
@@ -139,7 +284,55 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& del(const std::string& path, const std::vector<Middleware>& middlewares, F handler)
     {
-        registerHandlerWithMiddleware("DELETE", path, middlewares, handler);
+        registerHandler(HttpMethod::DELETE, path, middlewares, handler);
+        return *this;
+    }
+
+    /**
+     * @brief Register a DELETE route handler bound to a controller method at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @param path The route path; parsed by the compiler only if it is a constexpr pattern
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler>
+    RouteBinder& del(const RoutePattern& path, const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler>(HttpMethod::DELETE, path, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a DELETE route handler with middleware bound to a controller method at
+     * compile time
+     */
+    template <auto Handler>
+    RouteBinder& del(const RoutePattern& path, const Middleware& middleware)
+    {
+        bind<Handler>(HttpMethod::DELETE, path, {middleware});
+        return *this;
+    }
+
+    /**
+     * @brief Register a DELETE route handler whose pattern must be parsed at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @tparam Path A constexpr RoutePattern; anything else fails to compile
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& del(const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler, Path>(HttpMethod::DELETE, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a DELETE route handler with middleware whose pattern must be parsed at
+     * compile time
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& del(const Middleware& middleware)
+    {
+        bind<Handler, Path>(HttpMethod::DELETE, {middleware});
         return *this;
     }
 
@@ -148,7 +341,7 @@ template <typename ControllerT> class RouteBinder
      */
     template <typename F> RouteBinder& patch(const std::string& path, F handler)
     {
-        registerHandler("PATCH", path, handler);
+        registerHandler(HttpMethod::PATCH, path, {}, handler);
         return *this;
     }
 
@@ -158,7 +351,7 @@ template <typename ControllerT> class RouteBinder
     template <typename F>
     RouteBinder& patch(const std::string& path, const Middleware& middleware, F handler)
     {
-        registerHandlerWithMiddleware("PATCH", path, {middleware}, handler);
+        registerHandler(HttpMethod::PATCH, path, {middleware}, handler);
         return *this;
     }
 
@@ -169,7 +362,55 @@ template <typename ControllerT> class RouteBinder
     RouteBinder& patch(const std::string& path, const std::vector<Middleware>& middlewares,
                        F handler)
     {
-        registerHandlerWithMiddleware("PATCH", path, middlewares, handler);
+        registerHandler(HttpMethod::PATCH, path, middlewares, handler);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PATCH route handler bound to a controller method at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @param path The route path; parsed by the compiler only if it is a constexpr pattern
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler>
+    RouteBinder& patch(const RoutePattern& path, const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler>(HttpMethod::PATCH, path, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PATCH route handler with middleware bound to a controller method at
+     * compile time
+     */
+    template <auto Handler>
+    RouteBinder& patch(const RoutePattern& path, const Middleware& middleware)
+    {
+        bind<Handler>(HttpMethod::PATCH, path, {middleware});
+        return *this;
+    }
+
+    /**
+     * @brief Register a PATCH route handler whose pattern must be parsed at compile time
+     * @tparam Handler The controller method, e.g. &UserController::getUser
+     * @tparam Path A constexpr RoutePattern; anything else fails to compile
+     * @param middlewares The middleware to apply
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& patch(const std::vector<Middleware>& middlewares = {})
+    {
+        bind<Handler, Path>(HttpMethod::PATCH, middlewares);
+        return *this;
+    }
+
+    /**
+     * @brief Register a PATCH route handler with middleware whose pattern must be parsed at
+     * compile time
+     */
+    template <auto Handler, const RoutePattern& Path>
+    RouteBinder& patch(const Middleware& middleware)
+    {
+        bind<Handler, Path>(HttpMethod::PATCH, {middleware});
         return *this;
     }
 
@@ -226,66 +467,51 @@ template <typename ControllerT> class RouteBinder
     std::string basePath_;
 
     /**
-     * @brief Register a route handler using a controller method
+     * @brief Register a route handler that calls a controller method through a std::function
      */
     template <typename F>
-    void registerHandler(const std::string& method, const std::string& path, F handler)
+    void registerHandler(HttpMethod method, const std::string& path,
+                         const std::vector<Middleware>& middlewares, F handler)
     {
-        auto routeHandler = [this, handler](const Request& req, Response& res)
-        { (controller_.get()->*handler)(req, res); };
+        auto routeHandler = [controller = controller_, handler](const Request& req, Response& res)
+        { (controller.get()->*handler)(req, res); };
+        router_->route(method, path, routeHandler, middlewares);
+    }
 
-        if (method == "GET")
-        {
-            router_->get(path, routeHandler);
-        }
-        else if (method == "POST")
-        {
-            router_->post(path, routeHandler);
-        }
-        else if (method == "PUT")
-        {
-            router_->put(path, routeHandler);
-        }
-        else if (method == "DELETE")
-        {
-            router_->del(path, routeHandler);
-        }
-        else if (method == "PATCH")
-        {
-            router_->patch(path, routeHandler);
-        }
+    /**
+     * @brief Call a controller method fixed at compile time
+     */
+    template <auto Handler> static void invoke(void* controller, const Request& req, Response& res)
+    {
+        (static_cast<ControllerT*>(controller)->*Handler)(req, res);
     }
 
     /**
-     * @brief Register a route handler with middleware using a controller method
+     * @brief Register a controller method without std::function type erasure
      */
-    template <typename F>
-    void registerHandlerWithMiddleware(const std::string& method, const std::string& path,
-                                       const std::vector<Middleware>& middlewares, F handler)
+    template <auto Handler>
+    void bind(HttpMethod method, const RoutePattern& path,
+              const std::vector<Middleware>& middlewares)
     {
-        auto routeHandler = [this, handler](const Request& req, Response& res)
-        { (controller_.get()->*handler)(req, res); };
+        static_assert(std::is_member_function_pointer<decltype(Handler)>::value,
+                      "Handler must be a member function of the controller");
+        static_assert(std::is_invocable<decltype(Handler), ControllerT*, const Request&,
+                                        Response&>::value,
+                      "Handler must accept (const Request&, Response&)");
+        router_->route(method, path, DirectHandler{&invoke<Handler>, controller_}, middlewares);
+    }
 
-        if (method == "GET")
-        {
-            router_->get(path, middlewares, routeHandler);
-        }
-        else if (method == "POST")
-        {
-            router_->post(path, middlewares, routeHandler);
-        }
-        else if (method == "PUT")
-        {
-            router_->put(path, middlewares, routeHandler);
-        }
-        else if (method == "DELETE")
-        {
-            router_->del(path, middlewares, routeHandler);
-        }
-        else if (method == "PATCH")
-        {
-            router_->patch(path, middlewares, routeHandler);
-        }
+    /**
+     * @brief Register a controller method under a pattern the compiler has parsed
+     */
+    template <auto Handler, const RoutePattern& Path>
+    void bind(HttpMethod method, const std::vector<Middleware>& middlewares)
+    {
+        // Reading the pattern here is only a constant expression if it was built constexpr,
+        // which is what made the compiler reject a malformed one
+        static_assert(Path.paramCount() <= RoutePattern::kMaxParams,
+                      "Path must be a constexpr RoutePattern");
+        bind<Handler>(method, Path, middlewares);
     }
 };
 
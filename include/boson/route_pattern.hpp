@@ -0,0 +1,175 @@
+#ifndef BOSON_ROUTE_PATTERN_HPP
+#define BOSON_ROUTE_PATTERN_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace boson
+{
+
+/**
+ * @class RoutePattern
+ * @brief A route path checked and classified when it is constructed
+ *
+ * Every member is constexpr, so a pattern declared constexpr is parsed by the compiler and a
+ * malformed one fails to compile:
+ *
+ * @code
+ * static constexpr boson::RoutePattern kUserPosts("/users/:id/posts/:post");
+ * static_assert(kUserPosts.paramCount() == 2);
+ * @endcode
+ *
+ * Patterns built at run time, including string literals handed to Router, are checked the same
+ * way and throw std::invalid_argument instead. RouteBinder also takes a pattern as a template
+ * argument, which only compiles for a constexpr one.
+ */
+class RoutePattern
+{
+  public:
+    /// Most parameters (including a trailing wildcard) a single pattern may declare
+    static constexpr size_t kMaxParams = 16;
+
+    /**
+     * @brief Constructor
+     * @param path The route path; it is viewed, not copied
+     * @throws std::invalid_argument if the pattern is malformed
+     */
+    constexpr RoutePattern(const char* path) : RoutePattern(std::string_view(path)) {}
+
+    /**
+     * @brief Constructor
+     * @param path The route path; it is viewed, not copied
+     * @throws std::invalid_argument if the pattern is malformed
+     */
+    constexpr RoutePattern(std::string_view path) : path_(path) { scan(); }
+
+    /**
+     * @brief Constructor
+     * @param path The route path, which must outlive the pattern
+     * @throws std::invalid_argument if the pattern is malformed
+     */
+    RoutePattern(const std::string& path) : RoutePattern(std::string_view(path)) {}
+
+    /**
+     * @brief Get the route path
+     */
+    constexpr std::string_view path() const { return path_; }
+
+    /**
+     * @brief Get the number of :params, plus one for a trailing wildcard
+     */
+    constexpr size_t paramCount() const { return paramCount_; }
+
+    /**
+     * @brief Whether the pattern ends in a '*' that captures the rest of the path
+     */
+    constexpr bool hasWildcard() const { return wildcard_; }
+
+    /**
+     * @brief Whether the pattern uses regex syntax the radix tree cannot express
+     *
+     * Optional groups such as "/users(/:page)?" and character classes such as
+     * "/users/([0-9]+)" are matched through a regex compiled once at registration.
+     */
+    constexpr bool usesRegex() const { return regex_; }
+
+    /**
+     * @brief Whether a character may appear in a parameter name
+     */
+    static constexpr bool isParamChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_';
+    }
+
+  private:
+    constexpr void scan()
+    {
+        int groups = 0;
+        int classes = 0;
+        for (size_t i = 0; i < path_.size(); i++)
+        {
+            char c = path_[i];
+            if (c == ':' && i + 1 < path_.size() && isParamChar(path_[i + 1]))
+            {
+                paramCount_++;
+                while (i + 1 < path_.size() && isParamChar(path_[i + 1]))
+                {
+                    i++;
+                }
+                continue;
+            }
+            if (c == '*' && i + 1 == path_.size())
+            {
+                wildcard_ = true;
+                paramCount_++;
+                continue;
+            }
+            if (c == '\\')
+            {
+                regex_ = true;
+                i++;
+                continue;
+            }
+            switch (c)
+            {
+            case '(':
+                groups++;
+                break;
+            case ')':
+                if (--groups < 0)
+                {
+                    throw std::invalid_argument("Unbalanced ')' in route pattern");
+                }
+                break;
+            case '[':
+                classes++;
+                break;
+            case ']':
+                if (--classes < 0)
+                {
+                    throw std::invalid_argument("Unbalanced ']' in route pattern");
+                }
+                break;
+            case '{':
+            case '}':
+            case '?':
+            case '+':
+            case '|':
+            case '^':
+            case '$':
+            case '*':
+                break;
+            default:
+                continue;
+            }
+            regex_ = true;
+        }
+
+        if (groups != 0 || classes != 0)
+        {
+            throw std::invalid_argument("Unclosed group in route pattern");
+        }
+        if (paramCount_ > kMaxParams)
+        {
+            throw std::invalid_argument("Too many parameters in route pattern");
+        }
+        // Inside a regex a trailing '*' is a quantifier, not a wildcard parameter
+        if (regex_ && wildcard_)
+        {
+            wildcard_ = false;
+            paramCount_--;
+        }
+    }
+
+    std::string_view path_;
+    size_t paramCount_ = 0;
+    bool wildcard_ = false;
+    bool regex_ = false;
+};
+
+} // namespace boson
+
+#endif
@@ -1,13 +1,18 @@
 #ifndef BOSON_ROUTER_HPP
 #define BOSON_ROUTER_HPP
 
+#include "http_method.hpp"
 #include "middleware.hpp"
 #include "request.hpp"
 #include "response.hpp"
+#include "route_pattern.hpp"
+#include <array>
 #include <functional>
 #include <map>
 #include <memory>
+#include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace boson
@@ -24,6 +29,18 @@ using RouterPtr = std::shared_ptr<Router>;
  */
 using RouteHandler = std::function<void(const Request&, Response&)>;
 
+/**
+ * @brief Route handler called through a plain function pointer instead of a std::function
+ *
+ * RouteBinder generates one invoke function per controller method, so the method call is
+ * resolved at compile time and can be inlined into it.
+ */
+struct DirectHandler
+{
+    void (*invoke)(void* target, const Request& req, Response& res) = nullptr;
+    std::shared_ptr<void> target; ///< Passed to invoke; the route keeps it alive
+};
+
 /**
  * @class Router
  * @brief Router class for handling HTTP routes
@@ -171,6 +188,28 @@ class Router
     Router& patch(const std::string& path, const std::vector<Middleware>& middlewares,
                   const RouteHandler& handler);
 
+    /**
+     * @brief Register a route handler for any method
+     * @param method The HTTP method
+     * @param path The route path
+     * @param handler The handler function
+     * @param middlewares The middleware to apply
+     * @return Reference to this router for method chaining
+     */
+    Router& route(HttpMethod method, const RoutePattern& path, const RouteHandler& handler,
+                  const std::vector<Middleware>& middlewares = {});
+
+    /**
+     * @brief Register a handler that is called without std::function type erasure
+     * @param method The HTTP method
+     * @param path The route path
+     * @param handler The function pointer and the object it is called with
+     * @param middlewares The middleware to apply
+     * @return Reference to this router for method chaining
+     */
+    Router& route(HttpMethod method, const RoutePattern& path, DirectHandler handler,
+                  const std::vector<Middleware>& middlewares = {});
+
     /**
      * @brief Add middleware to the router
      * @param middleware The middleware function to add
@@ -180,19 +219,42 @@ class Router
 
     /**
      * @brief Mount a sub-router at the specified path
+     *
+     * The router's current routes are merged into this router's tables under the joined path,
+     * so later changes to it are not seen. Its handlers still see paths relative to the mount.
+     *
      * @param path The base path for the router
      * @param router The router to mount
      * @return Reference to this router for method chaining
      */
     Router& use(const std::string& path, const Router& router);
 
+    /**
+     * @brief Fold router middleware into every route so dispatch needs no further assembly
+     *
+     * Called by Server::listen(). Registering routes or middleware afterwards throws
+     * std::logic_error.
+     */
+    void freeze();
+
     /**
      * @brief Handle a request
+     *
+     * The matched route's parameters and mount point are recorded on the request, where its
+     * middleware and handler read them; they stay there after handle() returns.
+     *
      * @param req The HTTP request
      * @param res The HTTP response
      * @return True if the request was handled, false otherwise
      */
-    bool handle(const Request& req, Response& res) const;
+    bool handle(Request& req, Response& res) const;
+
+    /**
+     * @brief List the methods that have a route matching a path, including mounted routers
+     * @param path The request path
+     * @return Comma-separated methods for an Allow header, or an empty string if none match
+     */
+    std::string allowedMethods(std::string_view path) const;
 
     /**
      * @brief Create a new router
@@ -201,17 +263,58 @@ class Router
     static RouterPtr create();
 
   private:
+    /// Most parameters (including a trailing wildcard) a single route pattern may declare
+    static constexpr size_t kMaxRouteParams = RoutePattern::kMaxParams;
+
     struct Route
     {
-        std::string method;
+        HttpMethod method;
         std::string path;
         RouteHandler handler;
+        DirectHandler direct; ///< Used instead of handler when set
         std::vector<Middleware> middleware;
+        std::vector<std::string> paramNames;
+        std::shared_ptr<const std::regex> pattern; ///< Only for patterns using regex syntax
+        std::vector<size_t> paramGroups;           ///< Capture group of each param in pattern
+        size_t mountLength = 0; ///< Length of the joined mount path hidden from handlers
+        bool mounted = false;   ///< Merged from a sub-router, whose middleware is already folded in
+    };
+
+    /**
+     * @brief Radix tree node; children are indices into nodes so the router stays copyable
+     */
+    struct RouteNode
+    {
+        std::string prefix;           ///< Static label consumed by this node
+        std::vector<size_t> children; ///< Static children, distinct first characters
+        long paramChild = -1;         ///< Node matched by a :param, or -1
+        bool paramHasSuffix = false;  ///< A param child is followed by text in-segment
+        long route = -1;              ///< Route ending at this node, or -1
+        long wildcardRoute = -1;      ///< Route ending in '*' at this node, or -1
+    };
+
+    /**
+     * @brief Routes registered for one HTTP method
+     */
+    struct RouteTable
+    {
+        std::vector<RouteNode> nodes{RouteNode()};
+        std::vector<size_t> regexRoutes;
+    };
+
+    /**
+     * @brief Parameter values captured during lookup, as views into the request path
+     */
+    struct RouteMatch
+    {
+        std::array<std::string_view, kMaxRouteParams> values;
+        size_t count = 0;
     };
 
     std::vector<Route> routes;
+    std::array<RouteTable, kHttpMethodCount> tables;
     std::vector<Middleware> routerMiddleware;
-    std::vector<std::pair<std::string, Router>> subRouters;
+    bool frozen = false;
 
     /**
      * @brief Add a route to the router
@@ -220,8 +323,7 @@ class Router
      * @param handler The handler function
      * @return Reference to this router for method chaining
      */
-    Router& addRoute(const std::string& method, const std::string& path,
-                     const RouteHandler& handler);
+    Router& addRoute(HttpMethod method, const std::string& path, const RouteHandler& handler);
 
     /**
      * @brief Add a route with middleware
@@ -231,27 +333,50 @@ class Router
      * @param middleware The middleware vector to apply
      * @return Reference to this router for method chaining
      */
-    Router& addRouteWithMiddleware(const std::string& method, const std::string& path,
+    Router& addRouteWithMiddleware(HttpMethod method, const std::string& path,
                                    const RouteHandler& handler,
                                    const std::vector<Middleware>& middleware);
 
     /**
-     * @brief Match a path against a route pattern
-     * @param pattern The route pattern
+     * @brief Append a route and compile it
+     * @param route The route to add
+     * @param usesRegex What the route's RoutePattern reported, so the path is not parsed again
+     */
+    void insertRoute(Route route, bool usesRegex);
+
+    /**
+     * @brief Compile a registered route into its method's tree, or into a regex if it needs one
+     * @param routeIndex Index of the route in routes
+     * @param usesRegex Whether the path needs a regex
+     */
+    void compileRoute(size_t routeIndex, bool usesRegex);
+
+    /**
+     * @brief Add a static label below a node, splitting edges as needed
+     * @return Index of the node the label ends at
+     */
+    static size_t insertStatic(RouteTable& table, size_t node, std::string_view label);
+
+    /**
+     * @brief Find the route for a method and path
+     * @param method The HTTP method
      * @param path The request path
-     * @param params Map to store extracted parameters
-     * @return True if the path matches the pattern, false otherwise
+     * @param match Receives the captured parameter values
+     * @return The matching route, or nullptr
      */
-    bool matchPath(const std::string& pattern, const std::string& path,
-                   std::map<std::string, std::string>& params) const;
+    const Route* matchRoute(HttpMethod method, std::string_view path, RouteMatch& match) const;
 
     /**
-     * @brief Match a path against a route pattern
-     * @param pattern The route pattern
+     * @brief Walk a method's tree, preferring static over :param over '*'
+     * @param table The method's routes
+     * @param node Node to continue from
      * @param path The request path
-     * @return True if the path matches the pattern, false otherwise
+     * @param position Offset in path consumed so far
+     * @param match Receives the captured parameter values
+     * @return The matching route, or nullptr
      */
-    bool matchPath(const std::string& pattern, const std::string& path) const;
+    const Route* findRoute(const RouteTable& table, size_t node, std::string_view path,
+                           size_t position, RouteMatch& match) const;
 };
 
 } // namespace boson
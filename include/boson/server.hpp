@@ -15,6 +15,15 @@ namespace boson
 
 using ErrorHandler = std::function<void(const std::exception&, const Request&, Response&)>;
 
+/**
+ * @brief Socket I/O backend used by the server core
+ */
+enum class IoBackend
+{
+    Epoll,  ///< Readiness-based event loops (blocking workers where epoll is unavailable)
+    IoUring ///< Completion-based io_uring loops on Linux, falling back to Epoll if unsupported
+};
+
 /**
  * @class Server
  * @brief Main server class for the Boson framework
@@ -114,6 +123,86 @@ class Server
      */
     Server& setErrorHandler(const ErrorHandler& handler);
 
+    /**
+     * @brief Set how long an idle keep-alive connection is held open
+     * @param seconds Idle timeout in seconds (0 disables the timeout)
+     * @return Reference to this server for method chaining
+     */
+    Server& setKeepAliveTimeout(int seconds);
+
+    /**
+     * @brief Limit the number of requests served on one persistent connection
+     * @param maxRequests Maximum requests per connection (0 means unlimited)
+     * @return Reference to this server for method chaining
+     */
+    Server& setMaxRequestsPerConnection(size_t maxRequests);
+
+    /**
+     * @brief Limit the size of a request line and its header block
+     *
+     * Larger requests are answered with 431 Request Header Fields Too Large and the connection
+     * is closed. Call before listen().
+     *
+     * @param bytes Maximum size in bytes (64 KiB by default)
+     * @return Reference to this server for method chaining
+     */
+    Server& setMaxHeaderSize(size_t bytes);
+
+    /**
+     * @brief Limit the size of a request body
+     *
+     * A request whose Content-Length is larger is answered with 413 Content Too Large and the
+     * connection is closed, before any of the body is read. Call before listen().
+     *
+     * @param bytes Maximum size in bytes (16 MiB by default)
+     * @return Reference to this server for method chaining
+     */
+    Server& setMaxBodySize(size_t bytes);
+
+    /**
+     * @brief Open one SO_REUSEPORT listening socket per event loop
+     *
+     * The kernel spreads incoming connections across the listeners and each loop serves the
+     * connections it accepted on its own thread. Ignored where SO_REUSEPORT is unavailable.
+     *
+     * @param enable Whether to use one listener per event loop
+     * @return Reference to this server for method chaining
+     */
+    Server& setReusePort(bool enable = true);
+
+    /**
+     * @brief Select the socket I/O backend
+     * @param backend The backend to use; IoUring falls back to Epoll when unavailable
+     * @return Reference to this server for method chaining
+     */
+    Server& setIoBackend(IoBackend backend);
+
+    /**
+     * @brief Send a header with every response, such as Server or a security header
+     *
+     * Default headers are serialized once and copied into each response head as one block.
+     * A response that sets a header of the same name sends its own value instead. Call
+     * before listen().
+     *
+     * @param name The header name
+     * @param value The header value
+     * @return Reference to this server for method chaining
+     */
+    Server& setDefaultHeader(const std::string& name, const std::string& value);
+
+    /**
+     * @brief Compress responses automatically, negotiated from each request's Accept-Encoding
+     *
+     * Bodies at least options.minSize long whose Content-Type is on the allowlist are
+     * compressed with the first coding in options.encodings that the client accepts; streamed
+     * bodies are compressed chunk by chunk. A handler can still opt a response in or out with
+     * Response::compress(). Call before listen().
+     *
+     * @param options Size threshold, content types, codings and level
+     * @return Reference to this server for method chaining
+     */
+    Server& setCompression(const CompressionOptions& options = CompressionOptions());
+
   private:
     class Impl;
     std::unique_ptr<Impl> pimpl;
@@ -0,0 +1,118 @@
+#ifndef BOSON_STATIC_FILE_CACHE_HPP
+#define BOSON_STATIC_FILE_CACHE_HPP
+
+#include "compression.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace boson
+{
+
+class Request;
+class Response;
+
+/**
+ * @brief What a StaticFileCache holds and how it serves it
+ */
+struct StaticFileCacheOptions
+{
+    /// Bytes of file contents and compressed variants to hold; the least recently served
+    /// files are evicted to stay within it
+    size_t maxBytes = 64 * 1024 * 1024;
+
+    /// Files larger than this are sent with sendfile(2) instead of being cached
+    size_t maxFileSize = 4 * 1024 * 1024;
+
+    /// Compress each file on the compression allowlist once, when it is loaded
+    bool precompress = true;
+
+    /// Use name.br, name.zst and name.gz next to a file as its compressed variants, in
+    /// preference to compressing it; a sibling older than the file is ignored
+    bool precompressedFiles = true;
+
+    /// Watch the directory and drop files from the cache when they change on disk; only
+    /// Linux can watch files, elsewhere changed files are served until invalidate()
+    bool watch = true;
+
+    /// Cache-Control value sent with every file, or empty for none
+    std::string cacheControl;
+
+    /// Files to precompress and the codings to build; the level is higher than for dynamic
+    /// responses since each file is compressed only once
+    CompressionOptions compression{
+        1024, 9, {ContentEncoding::Brotli, ContentEncoding::Zstd, ContentEncoding::Gzip}};
+};
+
+/**
+ * @class StaticFileCache
+ * @brief Files of a directory held in memory with their headers and compressed variants
+ *
+ * A file is read the first time it is requested, together with its Content-Type, ETag,
+ * Last-Modified and compressed variants; after that, serving it is a hash lookup and the
+ * response shares the cached bytes. The cache is safe to use from every worker thread.
+ *
+ * Cached files are not checked against the disk on each request. Instead, on Linux a
+ * FileWatcher thread drops a file, or everything below a directory, as soon as inotify reports
+ * that it changed, including a precompressed sibling being replaced. Where files cannot be
+ * watched, call invalidate() after replacing them.
+ */
+class StaticFileCache
+{
+  public:
+    /**
+     * @brief Constructor
+     * @param root Directory to serve files from
+     * @param options Budget and compression settings
+     */
+    explicit StaticFileCache(const std::string& root,
+                             const StaticFileCacheOptions& options = StaticFileCacheOptions());
+    ~StaticFileCache();
+
+    StaticFileCache(const StaticFileCache&) = delete;
+    StaticFileCache& operator=(const StaticFileCache&) = delete;
+
+    /**
+     * @brief Respond with a file, loading it into the cache if it is not there yet
+     *
+     * Picks the compressed variant the client prefers and answers If-None-Match and
+     * If-Modified-Since with 304 Not Modified.
+     *
+     * @param request The request, whose Accept-Encoding and validators are read
+     * @param response The response to fill in
+     * @param relativePath Path of the file below the root; paths containing ".." are refused
+     * @return False if there is no such regular file, leaving the response untouched
+     */
+    bool serve(const Request& request, Response& response, std::string_view relativePath);
+
+    /**
+     * @brief Drop a file from the cache so that the next request reads it again
+     * @param relativePath Path of the file below the root
+     */
+    void invalidate(std::string_view relativePath);
+
+    /**
+     * @brief Drop every file from the cache
+     */
+    void clear();
+
+    /**
+     * @brief Check whether changes on disk are picked up without calling invalidate()
+     */
+    bool watching() const;
+
+    /**
+     * @brief Get the number of bytes the cached files and variants take up
+     */
+    size_t size() const;
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace boson
+
+#endif
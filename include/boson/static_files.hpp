@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <fstream>
 #include <unordered_map>
@@ -9,6 +10,7 @@
 #include "request.hpp"
 #include "response.hpp"
 #include "middleware.hpp"
+#include "static_file_cache.hpp"
 
 namespace boson {
 
@@ -53,6 +55,11 @@ public:
                 relativePath = relativePath.substr(1);
             }
             
+            if (!isSafePath(relativePath)) {
+                next();
+                return;
+            }
+
             // Construct the file path
             std::filesystem::path filePath = std::filesystem::path(root) / relativePath;
             
@@ -91,7 +98,73 @@ public:
         };
     }
 
+    /**
+     * @brief Create a middleware that serves files from memory, reading each once
+     *
+     * Files are cached with their headers and compressed variants in a StaticFileCache
+     * shared by every worker thread, within the byte budget in the options.
+     *
+     * @param root Directory path to serve files from
+     * @param urlPrefix URL prefix to mount the directory on
+     * @param options Cache budget, compression and Cache-Control settings
+     * @return Middleware function that can be passed to Server::use()
+     */
+    static Middleware createCached(
+        const std::string& root, const std::string& urlPrefix = "/",
+        const StaticFileCacheOptions& options = StaticFileCacheOptions()) {
+        return createCached(std::make_shared<StaticFileCache>(root, options), urlPrefix);
+    }
+
+    /**
+     * @brief Create a middleware that serves files from a cache the caller keeps a handle on
+     *
+     * @param cache The cache, e.g. to call invalidate() on when files are replaced
+     * @param urlPrefix URL prefix to mount the cache's directory on
+     * @return Middleware function that can be passed to Server::use()
+     */
+    static Middleware createCached(std::shared_ptr<StaticFileCache> cache,
+                                   const std::string& urlPrefix = "/") {
+        return [cache, urlPrefix](const Request& req, Response& res, NextFunction& next) {
+            std::string_view path = req.pathView();
+            if (req.methodView() != "GET" || path.compare(0, urlPrefix.size(), urlPrefix) != 0) {
+                next();
+                return;
+            }
+
+            std::string_view relativePath = path.substr(urlPrefix.size());
+            if (!relativePath.empty() && relativePath[0] == '/') {
+                relativePath.remove_prefix(1);
+            }
+            if (!cache->serve(req, res, relativePath)) {
+                next();
+            }
+        };
+    }
+
 private:
+    friend class StaticFileCache;
+
+    /**
+     * @brief Check that a request path stays below the served directory
+     */
+    static bool isSafePath(std::string_view relativePath) {
+        // A rooted path would replace the directory when the two are joined
+        if (!relativePath.empty() && (relativePath[0] == '/' || relativePath[0] == '\\')) {
+            return false;
+        }
+        while (!relativePath.empty()) {
+            size_t end = relativePath.find_first_of("/\\");
+            if (relativePath.substr(0, end) == "..") {
+                return false;
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            relativePath.remove_prefix(end + 1);
+        }
+        return true;
+    }
+
     static std::string getContentType(const std::string& extension) {
         static const std::unordered_map<std::string, std::string> contentTypes = {
             {".html", "text/html"},
@@ -0,0 +1,502 @@
+#include "boson/compression.hpp"
+#include "boson/http_headers.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef BOSON_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef BOSON_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef BOSON_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace boson
+{
+
+namespace
+{
+
+constexpr int kDefaultZlibLevel = 6;
+constexpr int kDefaultBrotliQuality = 5;
+constexpr int kDefaultZstdLevel = 3;
+
+/// Output grows in steps of this many bytes while a stream is flushed
+constexpr size_t kStreamOutputStep = 16 * 1024;
+
+std::string_view trimSpace(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    return text.substr(first, text.find_last_not_of(" \t") + 1 - first);
+}
+
+/**
+ * @brief Parse the q parameter of one Accept-Encoding entry, 1 if it has none
+ */
+double qualityOf(std::string_view parameters)
+{
+    while (!parameters.empty())
+    {
+        size_t end = parameters.find(';');
+        std::string_view parameter = trimSpace(parameters.substr(0, end));
+        if (parameter.size() >= 2 && (parameter[0] == 'q' || parameter[0] == 'Q') &&
+            parameter[1] == '=')
+        {
+            std::string value(parameter.substr(2));
+            return std::strtod(value.c_str(), nullptr);
+        }
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        parameters.remove_prefix(end + 1);
+    }
+    return 1.0;
+}
+
+} // namespace
+
+std::string_view contentEncodingName(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::Gzip:
+        return "gzip";
+    case ContentEncoding::Deflate:
+        return "deflate";
+    case ContentEncoding::Brotli:
+        return "br";
+    case ContentEncoding::Zstd:
+        return "zstd";
+    case ContentEncoding::Identity:
+        break;
+    }
+    return "identity";
+}
+
+bool contentEncodingAvailable(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::Identity:
+        return true;
+    case ContentEncoding::Gzip:
+    case ContentEncoding::Deflate:
+#ifdef BOSON_HAS_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case ContentEncoding::Brotli:
+#ifdef BOSON_HAS_BROTLI
+        return true;
+#else
+        return false;
+#endif
+    case ContentEncoding::Zstd:
+#ifdef BOSON_HAS_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool CompressionOptions::compressible(std::string_view contentType) const
+{
+    for (const auto& prefix : contentTypes)
+    {
+        if (contentType.size() >= prefix.size() &&
+            headerNameEquals(contentType.substr(0, prefix.size()), prefix))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double acceptQuality(std::string_view acceptEncoding, ContentEncoding encoding)
+{
+    // An explicit entry wins over "*"; a coding that is not listed is not acceptable
+    double quality = 0.0;
+    double wildcard = 0.0;
+    bool listed = false;
+    std::string_view remaining = acceptEncoding;
+    while (!remaining.empty())
+    {
+        size_t end = remaining.find(',');
+        std::string_view entry = remaining.substr(0, end);
+        size_t semicolon = entry.find(';');
+        std::string_view token = trimSpace(entry.substr(0, semicolon));
+        std::string_view parameters =
+            semicolon == std::string_view::npos ? std::string_view() : entry.substr(semicolon + 1);
+        if (headerNameEquals(token, contentEncodingName(encoding)))
+        {
+            quality = qualityOf(parameters);
+            listed = true;
+        }
+        else if (token == "*")
+        {
+            wildcard = qualityOf(parameters);
+        }
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        remaining.remove_prefix(end + 1);
+    }
+    return listed ? quality : wildcard;
+}
+
+ContentEncoding CompressionOptions::negotiate(std::string_view acceptEncoding) const
+{
+    ContentEncoding best = ContentEncoding::Identity;
+    double bestQuality = 0.0;
+    for (ContentEncoding encoding : encodings)
+    {
+        if (encoding == ContentEncoding::Identity || !contentEncodingAvailable(encoding))
+        {
+            continue;
+        }
+        double quality = acceptQuality(acceptEncoding, encoding);
+        if (quality > bestQuality)
+        {
+            best = encoding;
+            bestQuality = quality;
+        }
+    }
+    return best;
+}
+
+class Compressor::Impl
+{
+  public:
+    ~Impl()
+    {
+#ifdef BOSON_HAS_ZLIB
+        for (auto& context : zlib)
+        {
+            if (context.initialized)
+            {
+                deflateEnd(&context.stream);
+            }
+        }
+#endif
+#ifdef BOSON_HAS_BROTLI
+        if (brotli)
+        {
+            BrotliEncoderDestroyInstance(brotli);
+        }
+#endif
+#ifdef BOSON_HAS_ZSTD
+        ZSTD_freeCCtx(zstd);
+#endif
+    }
+
+    ContentEncoding streamEncoding = ContentEncoding::Identity;
+
+#ifdef BOSON_HAS_ZLIB
+    struct ZlibContext
+    {
+        z_stream stream{};
+        bool initialized = false;
+        int level = 0;
+    };
+    // Gzip and deflate differ in their framing, so each keeps a context
+    ZlibContext zlib[2];
+
+    /**
+     * @brief Get a reset zlib context for a coding and level, creating it on first use
+     */
+    z_stream* zlibStream(ContentEncoding encoding, int level)
+    {
+        level = level < 0 ? kDefaultZlibLevel : level;
+        ZlibContext& context = zlib[encoding == ContentEncoding::Gzip ? 0 : 1];
+        if (!context.initialized)
+        {
+            // 15 window bits; adding 16 selects the gzip wrapper instead of zlib's
+            int windowBits = encoding == ContentEncoding::Gzip ? 15 + 16 : 15;
+            if (deflateInit2(&context.stream, level, Z_DEFLATED, windowBits, 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return nullptr;
+            }
+            context.initialized = true;
+            context.level = level;
+            return &context.stream;
+        }
+        deflateReset(&context.stream);
+        if (context.level != level)
+        {
+            deflateParams(&context.stream, level, Z_DEFAULT_STRATEGY);
+            context.level = level;
+        }
+        return &context.stream;
+    }
+
+    bool zlibWrite(z_stream* stream, std::string_view input, std::string& out, int flush)
+    {
+        stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream->avail_in = static_cast<uInt>(input.size());
+        for (;;)
+        {
+            size_t used = out.size();
+            out.resize(used + kStreamOutputStep);
+            stream->next_out = reinterpret_cast<Bytef*>(&out[used]);
+            stream->avail_out = static_cast<uInt>(kStreamOutputStep);
+            int result = deflate(stream, flush);
+            out.resize(out.size() - stream->avail_out);
+            if (result == Z_STREAM_END)
+            {
+                return true;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR)
+            {
+                return false;
+            }
+            // Output is complete once deflate stops filling the buffer it is given
+            if (stream->avail_out != 0 && flush != Z_FINISH)
+            {
+                return true;
+            }
+        }
+    }
+#endif
+
+#ifdef BOSON_HAS_BROTLI
+    // Brotli encoders cannot be reset, so a stream gets a fresh one
+    BrotliEncoderState* brotli = nullptr;
+
+    bool brotliWrite(std::string_view input, std::string& out, bool finish)
+    {
+        size_t availableIn = input.size();
+        const uint8_t* nextIn = reinterpret_cast<const uint8_t*>(input.data());
+        BrotliEncoderOperation operation =
+            finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+        do
+        {
+            size_t availableOut = 0;
+            if (!BrotliEncoderCompressStream(brotli, operation, &availableIn, &nextIn,
+                                             &availableOut, nullptr, nullptr))
+            {
+                return false;
+            }
+            size_t produced = 0;
+            const uint8_t* output = BrotliEncoderTakeOutput(brotli, &produced);
+            out.append(reinterpret_cast<const char*>(output), produced);
+        } while (availableIn > 0 || BrotliEncoderHasMoreOutput(brotli) ||
+                 (finish && !BrotliEncoderIsFinished(brotli)));
+        return true;
+    }
+#endif
+
+#ifdef BOSON_HAS_ZSTD
+    ZSTD_CCtx* zstd = nullptr;
+
+    ZSTD_CCtx* zstdContext(int level)
+    {
+        if (!zstd)
+        {
+            zstd = ZSTD_createCCtx();
+            if (!zstd)
+            {
+                return nullptr;
+            }
+        }
+        ZSTD_CCtx_reset(zstd, ZSTD_reset_session_only);
+        ZSTD_CCtx_setParameter(zstd, ZSTD_c_compressionLevel,
+                               level < 0 ? kDefaultZstdLevel : level);
+        return zstd;
+    }
+
+    bool zstdWrite(std::string_view input, std::string& out, bool finish)
+    {
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+        ZSTD_EndDirective directive = finish ? ZSTD_e_end : ZSTD_e_flush;
+        for (;;)
+        {
+            size_t used = out.size();
+            out.resize(used + kStreamOutputStep);
+            ZSTD_outBuffer buffer{&out[used], kStreamOutputStep, 0};
+            size_t remaining = ZSTD_compressStream2(zstd, &buffer, &in, directive);
+            out.resize(used + buffer.pos);
+            if (ZSTD_isError(remaining))
+            {
+                return false;
+            }
+            if (remaining == 0 && in.pos == in.size)
+            {
+                return true;
+            }
+        }
+    }
+#endif
+};
+
+Compressor::Compressor() : pimpl(std::make_unique<Impl>()) {}
+
+Compressor::~Compressor() {}
+
+bool Compressor::compress(ContentEncoding encoding, std::string_view input, std::string& out,
+                          int level)
+{
+    out.clear();
+    switch (encoding)
+    {
+#ifdef BOSON_HAS_ZLIB
+    case ContentEncoding::Gzip:
+    case ContentEncoding::Deflate:
+    {
+        z_stream* stream = pimpl->zlibStream(encoding, level);
+        if (!stream)
+        {
+            return false;
+        }
+        out.resize(deflateBound(stream, static_cast<uLong>(input.size())));
+        stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream->avail_in = static_cast<uInt>(input.size());
+        stream->next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream->avail_out = static_cast<uInt>(out.size());
+        bool done = deflate(stream, Z_FINISH) == Z_STREAM_END;
+        out.resize(done ? stream->total_out : 0);
+        return done;
+    }
+#endif
+#ifdef BOSON_HAS_BROTLI
+    case ContentEncoding::Brotli:
+    {
+        size_t size = BrotliEncoderMaxCompressedSize(input.size());
+        out.resize(size);
+        bool done = BrotliEncoderCompress(
+            level < 0 ? kDefaultBrotliQuality : level, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+            input.size(), reinterpret_cast<const uint8_t*>(input.data()), &size,
+            reinterpret_cast<uint8_t*>(&out[0]));
+        out.resize(done ? size : 0);
+        return done;
+    }
+#endif
+#ifdef BOSON_HAS_ZSTD
+    case ContentEncoding::Zstd:
+    {
+        ZSTD_CCtx* context = pimpl->zstdContext(level);
+        if (!context)
+        {
+            return false;
+        }
+        out.resize(ZSTD_compressBound(input.size()));
+        size_t size = ZSTD_compress2(context, &out[0], out.size(), input.data(), input.size());
+        bool done = !ZSTD_isError(size);
+        out.resize(done ? size : 0);
+        return done;
+    }
+#endif
+    default:
+        (void)input;
+        (void)level;
+        return false;
+    }
+}
+
+bool Compressor::begin(ContentEncoding encoding, int level)
+{
+    pimpl->streamEncoding = ContentEncoding::Identity;
+    switch (encoding)
+    {
+#ifdef BOSON_HAS_ZLIB
+    case ContentEncoding::Gzip:
+    case ContentEncoding::Deflate:
+        if (!pimpl->zlibStream(encoding, level))
+        {
+            return false;
+        }
+        break;
+#endif
+#ifdef BOSON_HAS_BROTLI
+    case ContentEncoding::Brotli:
+        if (pimpl->brotli)
+        {
+            BrotliEncoderDestroyInstance(pimpl->brotli);
+        }
+        pimpl->brotli = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+        if (!pimpl->brotli)
+        {
+            return false;
+        }
+        BrotliEncoderSetParameter(pimpl->brotli, BROTLI_PARAM_QUALITY,
+                                  static_cast<uint32_t>(level < 0 ? kDefaultBrotliQuality
+                                                                  : level));
+        BrotliEncoderSetParameter(pimpl->brotli, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+        break;
+#endif
+#ifdef BOSON_HAS_ZSTD
+    case ContentEncoding::Zstd:
+        if (!pimpl->zstdContext(level))
+        {
+            return false;
+        }
+        break;
+#endif
+    default:
+        (void)level;
+        return false;
+    }
+    pimpl->streamEncoding = encoding;
+    return true;
+}
+
+bool Compressor::write(std::string_view input, std::string& out, bool finish)
+{
+    bool ok = false;
+    switch (pimpl->streamEncoding)
+    {
+#ifdef BOSON_HAS_ZLIB
+    case ContentEncoding::Gzip:
+    case ContentEncoding::Deflate:
+    {
+        auto& context = pimpl->zlib[pimpl->streamEncoding == ContentEncoding::Gzip ? 0 : 1];
+        ok = pimpl->zlibWrite(&context.stream, input, out, finish ? Z_FINISH : Z_SYNC_FLUSH);
+        break;
+    }
+#endif
+#ifdef BOSON_HAS_BROTLI
+    case ContentEncoding::Brotli:
+        ok = pimpl->brotliWrite(input, out, finish);
+        if (finish)
+        {
+            BrotliEncoderDestroyInstance(pimpl->brotli);
+            pimpl->brotli = nullptr;
+        }
+        break;
+#endif
+#ifdef BOSON_HAS_ZSTD
+    case ContentEncoding::Zstd:
+        ok = pimpl->zstdWrite(input, out, finish);
+        break;
+#endif
+    default:
+        (void)input;
+        (void)out;
+        return false;
+    }
+    if (finish || !ok)
+    {
+        pimpl->streamEncoding = ContentEncoding::Identity;
+    }
+    return ok;
+}
+
+Compressor& Compressor::local()
+{
+    thread_local Compressor compressor;
+    return compressor;
+}
+
+} // namespace boson
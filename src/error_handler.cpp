@@ -27,6 +27,17 @@ ForbiddenError::ForbiddenError(const std::string& message) : HttpError(message,
 
 NotFoundError::NotFoundError(const std::string& message) : HttpError(message, 404) {}
 
+MethodNotAllowedError::MethodNotAllowedError(const std::string& message,
+                                             const std::string& allow)
+    : HttpError(message, 405), allowedMethods(allow)
+{
+}
+
+const std::string& MethodNotAllowedError::allow() const
+{
+    return allowedMethods;
+}
+
 void defaultErrorHandler(const std::exception& err, const Request& req, Response& res)
 {
 
@@ -39,6 +50,12 @@ void defaultErrorHandler(const std::exception& err, const Request& req, Response
         statusCode = httpError->statusCode();
     }
 
+    const MethodNotAllowedError* methodError = dynamic_cast<const MethodNotAllowedError*>(&err);
+    if (methodError)
+    {
+        res.header("Allow", methodError->allow());
+    }
+
     std::cerr << "Error: " << errorMessage << " [" << statusCode << "]" << std::endl;
 
     std::string jsonResponse = "{\n";
@@ -0,0 +1,296 @@
+#include "boson/file_watcher.hpp"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace boson
+{
+
+#ifdef __linux__
+
+namespace
+{
+
+/// Events that can make a cached file or its metadata stale
+constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF |
+                                IN_ONLYDIR;
+
+} // namespace
+
+class FileWatcher::Impl
+{
+  public:
+    ~Impl()
+    {
+        if (thread.joinable())
+        {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+            thread.join();
+        }
+        if (inotifyFd >= 0)
+        {
+            ::close(inotifyFd);
+        }
+        if (wakeFd >= 0)
+        {
+            ::close(wakeFd);
+        }
+    }
+
+    /**
+     * @brief A directory passed to watch(), with everything needed to report its changes
+     */
+    struct Root
+    {
+        std::filesystem::path directory;
+        bool recursive;
+        Callback callback;
+    };
+
+    /**
+     * @brief A directory inotify watches: a root or, for a recursive root, one below it
+     */
+    struct Watch
+    {
+        std::filesystem::path directory;
+        Root* root;
+    };
+
+    struct Change
+    {
+        Root* root;
+        std::filesystem::path path;
+        bool directory;
+    };
+
+    bool open()
+    {
+        if (inotifyFd < 0)
+        {
+            inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        }
+        if (wakeFd < 0)
+        {
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        }
+        return inotifyFd >= 0 && wakeFd >= 0;
+    }
+
+    bool addDirectory(const std::filesystem::path& directory, Root* root)
+    {
+        int wd = inotify_add_watch(inotifyFd, directory.c_str(), kWatchMask);
+        if (wd < 0)
+        {
+            return false;
+        }
+        // Watching a directory again returns the same descriptor, e.g. after it moved
+        watches[wd] = Watch{directory, root};
+        return true;
+    }
+
+    /**
+     * @brief Watch a directory and every directory below it
+     * @return False if the directory itself could not be watched
+     */
+    bool addTree(const std::filesystem::path& directory, Root* root)
+    {
+        if (!addDirectory(directory, root))
+        {
+            return false;
+        }
+        std::error_code error;
+        std::filesystem::recursive_directory_iterator it(
+            directory, std::filesystem::directory_options::skip_permission_denied, error);
+        std::filesystem::recursive_directory_iterator end;
+        for (; !error && it != end; it.increment(error))
+        {
+            if (it->is_directory(error) && !it->is_symlink(error))
+            {
+                addDirectory(it->path(), root);
+            }
+        }
+        return true;
+    }
+
+    void run()
+    {
+        // inotify_event is followed by its name, so the buffer is aligned for the header
+        alignas(struct inotify_event) char buffer[16 * 1024];
+        struct pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        std::vector<Change> changes;
+
+        while (true)
+        {
+            if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+            {
+                return;
+            }
+            if (fds[1].revents)
+            {
+                return;
+            }
+            ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                continue;
+            }
+
+            changes.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (char* p = buffer; p < buffer + length;)
+                {
+                    const auto* event = reinterpret_cast<const struct inotify_event*>(p);
+                    p += sizeof(struct inotify_event) + event->len;
+                    collect(*event, changes);
+                }
+            }
+
+            // Callbacks run without the lock so that they may take locks of their own
+            for (const Change& change : changes)
+            {
+                change.root->callback(change.path, change.directory);
+            }
+        }
+    }
+
+    /**
+     * @brief Turn one event into the changes to report, updating the watches it affects
+     */
+    void collect(const struct inotify_event& event, std::vector<Change>& changes)
+    {
+        // The kernel dropped events, so anything may have changed
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            for (Root& root : roots)
+            {
+                changes.push_back(Change{&root, root.directory, true});
+            }
+            return;
+        }
+
+        auto it = watches.find(event.wd);
+        if (it == watches.end())
+        {
+            return;
+        }
+        if (event.mask & IN_IGNORED)
+        {
+            watches.erase(it);
+            return;
+        }
+        Watch watch = it->second;
+
+        if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+        {
+            // Its parent reports a subdirectory; only a root has to report itself
+            if (watch.directory == watch.root->directory)
+            {
+                changes.push_back(Change{watch.root, watch.directory, true});
+                // Stop following a directory that moved away, and follow one that took its
+                // name
+                if (event.mask & IN_MOVE_SELF)
+                {
+                    inotify_rm_watch(inotifyFd, event.wd);
+                }
+                std::error_code error;
+                if (std::filesystem::is_directory(watch.directory, error))
+                {
+                    watch.root->recursive ? addTree(watch.directory, watch.root)
+                                          : addDirectory(watch.directory, watch.root);
+                }
+            }
+            return;
+        }
+
+        std::filesystem::path path =
+            event.len > 0 ? watch.directory / std::string(event.name) : watch.directory;
+        bool directory = (event.mask & IN_ISDIR) != 0;
+        if (directory && watch.root->recursive && (event.mask & (IN_CREATE | IN_MOVED_TO)))
+        {
+            addTree(path, watch.root);
+        }
+        changes.push_back(Change{watch.root, std::move(path), directory});
+    }
+
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::mutex mutex;
+    std::deque<Root> roots; ///< Watches point into it; only a root that failed is removed
+    std::unordered_map<int, Watch> watches;
+    std::thread thread;
+};
+
+FileWatcher::FileWatcher() : pimpl(std::make_unique<Impl>()) {}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::supported()
+{
+    return true;
+}
+
+bool FileWatcher::watch(const std::filesystem::path& directory, bool recursive,
+                        Callback callback)
+{
+    std::lock_guard<std::mutex> lock(pimpl->mutex);
+    if (!pimpl->open())
+    {
+        return false;
+    }
+    pimpl->roots.push_back(Impl::Root{directory, recursive, std::move(callback)});
+    Impl::Root* root = &pimpl->roots.back();
+    bool watching = recursive ? pimpl->addTree(directory, root)
+                              : pimpl->addDirectory(directory, root);
+    if (!watching)
+    {
+        pimpl->roots.pop_back();
+        return false;
+    }
+    if (!pimpl->thread.joinable())
+    {
+        pimpl->thread = std::thread(&Impl::run, pimpl.get());
+    }
+    return true;
+}
+
+#else
+
+class FileWatcher::Impl
+{
+};
+
+FileWatcher::FileWatcher() : pimpl(std::make_unique<Impl>()) {}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::supported()
+{
+    return false;
+}
+
+bool FileWatcher::watch(const std::filesystem::path&, bool, Callback)
+{
+    return false;
+}
+
+#endif
+
+} // namespace boson
@@ -0,0 +1,87 @@
+#include "boson/http_date.hpp"
+
+#include <chrono>
+
+namespace boson
+{
+
+namespace
+{
+
+constexpr const char kDayNames[] = "SunMonTueWedThuFriSat";
+constexpr const char kMonthNames[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+void writeTwoDigits(char* out, int value)
+{
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+}
+
+} // namespace
+
+void formatHttpDate(std::time_t time, char* out)
+{
+    std::tm parts{};
+#ifdef _WIN32
+    gmtime_s(&parts, &time);
+#else
+    gmtime_r(&time, &parts);
+#endif
+
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    const char* day = kDayNames + 3 * parts.tm_wday;
+    const char* month = kMonthNames + 3 * parts.tm_mon;
+    int year = parts.tm_year + 1900;
+    out[0] = day[0];
+    out[1] = day[1];
+    out[2] = day[2];
+    out[3] = ',';
+    out[4] = ' ';
+    writeTwoDigits(out + 5, parts.tm_mday);
+    out[7] = ' ';
+    out[8] = month[0];
+    out[9] = month[1];
+    out[10] = month[2];
+    out[11] = ' ';
+    writeTwoDigits(out + 12, year / 100 % 100);
+    writeTwoDigits(out + 14, year % 100);
+    out[16] = ' ';
+    writeTwoDigits(out + 17, parts.tm_hour);
+    out[19] = ':';
+    writeTwoDigits(out + 20, parts.tm_min);
+    out[22] = ':';
+    writeTwoDigits(out + 23, parts.tm_sec);
+    out[25] = ' ';
+    out[26] = 'G';
+    out[27] = 'M';
+    out[28] = 'T';
+}
+
+void formatHttpDate(std::filesystem::file_time_type time, char* out)
+{
+    // The file clock's epoch is unspecified in C++17, so convert through the current time
+    auto sysTime = std::chrono::system_clock::now() +
+                   std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                       time - std::filesystem::file_time_type::clock::now());
+    formatHttpDate(std::chrono::system_clock::to_time_t(sysTime), out);
+}
+
+std::string_view currentHttpDate()
+{
+    struct Cache
+    {
+        std::time_t second = -1;
+        char text[kHttpDateLength];
+    };
+    thread_local Cache cache;
+
+    std::time_t now = std::time(nullptr);
+    if (now != cache.second)
+    {
+        formatHttpDate(now, cache.text);
+        cache.second = now;
+    }
+    return std::string_view(cache.text, kHttpDateLength);
+}
+
+} // namespace boson
@@ -0,0 +1,200 @@
+#include "boson/http_headers.hpp"
+
+namespace boson
+{
+
+namespace
+{
+
+constexpr std::string_view kKnownHeaderNames[kKnownHeaderCount + 1] = {
+    "Accept", "Accept-Encoding", "Authorization", "Cache-Control", "Connection",
+    "Content-Encoding", "Content-Length", "Content-Type", "Cookie", "Date", "ETag", "Host",
+    "If-Modified-Since", "If-None-Match", "Last-Modified", "Server", "Transfer-Encoding",
+    "User-Agent", "Vary", ""};
+
+inline char lowerAscii(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+} // namespace
+
+bool headerNameEquals(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i] != b[i] && lowerAscii(a[i]) != lowerAscii(b[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+KnownHeader knownHeaderFromName(std::string_view name)
+{
+    // Length and first letter narrow every known name to one candidate
+    KnownHeader candidate = KnownHeader::Unknown;
+    char first = name.empty() ? '\0' : lowerAscii(name[0]);
+    switch (name.size())
+    {
+    case 4:
+        candidate = first == 'd'   ? KnownHeader::Date
+                    : first == 'e' ? KnownHeader::ETag
+                    : first == 'h' ? KnownHeader::Host
+                                   : KnownHeader::Vary;
+        break;
+    case 6:
+        candidate = first == 'a'   ? KnownHeader::Accept
+                    : first == 'c' ? KnownHeader::Cookie
+                                   : KnownHeader::Server;
+        break;
+    case 10:
+        candidate = first == 'c' ? KnownHeader::Connection : KnownHeader::UserAgent;
+        break;
+    case 12:
+        candidate = KnownHeader::ContentType;
+        break;
+    case 13:
+        candidate = first == 'a'   ? KnownHeader::Authorization
+                    : first == 'c' ? KnownHeader::CacheControl
+                    : first == 'i' ? KnownHeader::IfNoneMatch
+                                   : KnownHeader::LastModified;
+        break;
+    case 14:
+        candidate = KnownHeader::ContentLength;
+        break;
+    case 15:
+        candidate = KnownHeader::AcceptEncoding;
+        break;
+    case 16:
+        candidate = KnownHeader::ContentEncoding;
+        break;
+    case 17:
+        candidate = first == 'i' ? KnownHeader::IfModifiedSince : KnownHeader::TransferEncoding;
+        break;
+    default:
+        return KnownHeader::Unknown;
+    }
+    return headerNameEquals(name, knownHeaderName(candidate)) ? candidate : KnownHeader::Unknown;
+}
+
+std::string_view knownHeaderName(KnownHeader header)
+{
+    return kKnownHeaderNames[static_cast<size_t>(header)];
+}
+
+HeaderList::HeaderList(std::pmr::memory_resource* memory) : entries_(memory)
+{
+    known_.fill(kNoEntry);
+}
+
+long HeaderList::indexOf(std::string_view name, KnownHeader header) const
+{
+    if (header != KnownHeader::Unknown)
+    {
+        uint32_t index = known_[static_cast<size_t>(header)];
+        return index == kNoEntry ? -1 : static_cast<long>(index);
+    }
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        if (headerNameEquals(entries_[i].name, name))
+        {
+            return static_cast<long>(i);
+        }
+    }
+    return -1;
+}
+
+void HeaderList::set(std::string_view name, std::string_view value)
+{
+    assign(name, knownHeaderFromName(name), value);
+}
+
+void HeaderList::set(KnownHeader header, std::string_view value)
+{
+    assign(knownHeaderName(header), header, value);
+}
+
+void HeaderList::assign(std::string_view name, KnownHeader header, std::string_view value)
+{
+    long index = indexOf(name, header);
+    if (index >= 0)
+    {
+        entries_[static_cast<size_t>(index)].value.assign(value.data(), value.size());
+        return;
+    }
+    if (header != KnownHeader::Unknown)
+    {
+        known_[static_cast<size_t>(header)] = static_cast<uint32_t>(entries_.size());
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.name.assign(name.data(), name.size());
+    entry.value.assign(value.data(), value.size());
+}
+
+const std::pmr::string* HeaderList::find(std::string_view name) const
+{
+    long index = indexOf(name, knownHeaderFromName(name));
+    return index < 0 ? nullptr : &entries_[static_cast<size_t>(index)].value;
+}
+
+const std::pmr::string* HeaderList::find(KnownHeader header) const
+{
+    if (header == KnownHeader::Unknown)
+    {
+        return nullptr;
+    }
+    uint32_t index = known_[static_cast<size_t>(header)];
+    return index == kNoEntry ? nullptr : &entries_[index].value;
+}
+
+bool HeaderList::erase(std::string_view name)
+{
+    long index = indexOf(name, knownHeaderFromName(name));
+    if (index < 0)
+    {
+        return false;
+    }
+    entries_.erase(entries_.begin() + index);
+    reindex();
+    return true;
+}
+
+void HeaderList::clear()
+{
+    entries_.clear();
+    known_.fill(kNoEntry);
+}
+
+void HeaderList::reindex()
+{
+    known_.fill(kNoEntry);
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        KnownHeader header = knownHeaderFromName(entries_[i].name);
+        if (header != KnownHeader::Unknown)
+        {
+            known_[static_cast<size_t>(header)] = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+void HeaderBlock::set(std::string_view name, std::string_view value)
+{
+    headers_.set(name, value);
+    bytes_.clear();
+    for (const auto& header : headers_)
+    {
+        bytes_.append(header.name.data(), header.name.size());
+        bytes_ += ": ";
+        bytes_.append(header.value.data(), header.value.size());
+        bytes_ += "\r\n";
+    }
+}
+
+} // namespace boson
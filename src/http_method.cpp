@@ -0,0 +1,55 @@
+#include "boson/http_method.hpp"
+
+namespace boson
+{
+
+namespace
+{
+
+constexpr std::string_view kMethodNames[kHttpMethodCount] = {
+    "GET", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "HEAD", "CONNECT", "TRACE", ""};
+
+} // namespace
+
+HttpMethod httpMethodFromString(std::string_view name)
+{
+    // The first character and length narrow every standard method to one candidate
+    size_t candidate = kHttpMethodCount - 1;
+    switch (name.empty() ? '\0' : name[0])
+    {
+    case 'G':
+        candidate = static_cast<size_t>(HttpMethod::GET);
+        break;
+    case 'P':
+        candidate = static_cast<size_t>(name.size() == 3   ? HttpMethod::PUT
+                                        : name.size() == 4 ? HttpMethod::POST
+                                                           : HttpMethod::PATCH);
+        break;
+    case 'D':
+        candidate = static_cast<size_t>(HttpMethod::DELETE);
+        break;
+    case 'O':
+        candidate = static_cast<size_t>(HttpMethod::OPTIONS);
+        break;
+    case 'H':
+        candidate = static_cast<size_t>(HttpMethod::HEAD);
+        break;
+    case 'C':
+        candidate = static_cast<size_t>(HttpMethod::CONNECT);
+        break;
+    case 'T':
+        candidate = static_cast<size_t>(HttpMethod::TRACE);
+        break;
+    default:
+        break;
+    }
+    return name == kMethodNames[candidate] ? static_cast<HttpMethod>(candidate)
+                                           : HttpMethod::UNKNOWN;
+}
+
+std::string_view httpMethodName(HttpMethod method)
+{
+    return kMethodNames[static_cast<size_t>(method)];
+}
+
+} // namespace boson
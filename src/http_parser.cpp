@@ -0,0 +1,601 @@
+#include "boson/http_parser.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define BOSON_HAS_X86_SIMD 1
+#endif
+
+namespace boson
+{
+
+namespace
+{
+
+constexpr bool isTokenByte(unsigned char c)
+{
+    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+    {
+        return true;
+    }
+    switch (c)
+    {
+    case '!':
+    case '#':
+    case '$':
+    case '%':
+    case '&':
+    case '\'':
+    case '*':
+    case '+':
+    case '-':
+    case '.':
+    case '^':
+    case '_':
+    case '`':
+    case '|':
+    case '~':
+        return true;
+    default:
+        return false;
+    }
+}
+
+constexpr std::array<bool, 256> makeTokenTable()
+{
+    std::array<bool, 256> table{};
+    for (unsigned c = 0; c < 256; c++)
+    {
+        table[c] = isTokenByte(static_cast<unsigned char>(c));
+    }
+    return table;
+}
+
+constexpr std::array<bool, 256> kTokenTable = makeTokenTable();
+
+inline bool isTokenChar(unsigned char c)
+{
+    return kTokenTable[c];
+}
+
+inline bool isDelimiter(unsigned char c)
+{
+    return c <= ' ' || c == 0x7f;
+}
+
+/*
+ * Scanning kernels. Each returns the index of the first byte in [position, end) that matches,
+ * or end. lineEnd looks for CR or LF, delimiter for a control character, space or DEL (the end
+ * of the request target) and nameEnd additionally for ':' (the end of a header name).
+ */
+
+size_t lineEndScalar(const char* data, size_t position, size_t end)
+{
+    while (position < end && data[position] != '\r' && data[position] != '\n')
+    {
+        position++;
+    }
+    return position;
+}
+
+size_t delimiterScalar(const char* data, size_t position, size_t end)
+{
+    while (position < end && !isDelimiter(static_cast<unsigned char>(data[position])))
+    {
+        position++;
+    }
+    return position;
+}
+
+size_t nameEndScalar(const char* data, size_t position, size_t end)
+{
+    while (position < end && data[position] != ':' &&
+           !isDelimiter(static_cast<unsigned char>(data[position])))
+    {
+        position++;
+    }
+    return position;
+}
+
+#ifdef BOSON_HAS_X86_SIMD
+
+__attribute__((target("sse4.2"))) size_t lineEndSse42(const char* data, size_t position,
+                                                       size_t end)
+{
+    const __m128i set = _mm_setr_epi8('\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; position + 16 <= end; position += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        int index = _mm_cmpestri(set, 2, block, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16)
+        {
+            return position + static_cast<size_t>(index);
+        }
+    }
+    return lineEndScalar(data, position, end);
+}
+
+__attribute__((target("sse4.2"))) size_t delimiterSse42(const char* data, size_t position,
+                                                        size_t end)
+{
+    const __m128i ranges = _mm_setr_epi8(0, ' ', 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; position + 16 <= end; position += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        int index = _mm_cmpestri(ranges, 4, block, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16)
+        {
+            return position + static_cast<size_t>(index);
+        }
+    }
+    return delimiterScalar(data, position, end);
+}
+
+__attribute__((target("sse4.2"))) size_t nameEndSse42(const char* data, size_t position,
+                                                      size_t end)
+{
+    const __m128i ranges =
+        _mm_setr_epi8(0, ' ', ':', ':', 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    for (; position + 16 <= end; position += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        int index = _mm_cmpestri(ranges, 6, block, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index < 16)
+        {
+            return position + static_cast<size_t>(index);
+        }
+    }
+    return nameEndScalar(data, position, end);
+}
+
+__attribute__((target("avx2"))) inline __m256i delimiterMaskAvx2(__m256i block)
+{
+    // Signed compares: bytes 0x00-0x20 are below 0x21 and not negative (0x80-0xff are text)
+    __m256i low = _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x21), block),
+                                   _mm256_cmpgt_epi8(block, _mm256_set1_epi8(-1)));
+    return _mm256_or_si256(low, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(0x7f)));
+}
+
+__attribute__((target("avx2"))) size_t lineEndAvx2(const char* data, size_t position,
+                                                   size_t end)
+{
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    for (; position + 32 <= end; position += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, cr), _mm256_cmpeq_epi8(block, lf))));
+        if (mask != 0)
+        {
+            return position + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return lineEndScalar(data, position, end);
+}
+
+__attribute__((target("avx2"))) size_t delimiterAvx2(const char* data, size_t position,
+                                                     size_t end)
+{
+    for (; position + 32 <= end; position += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(delimiterMaskAvx2(block)));
+        if (mask != 0)
+        {
+            return position + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return delimiterScalar(data, position, end);
+}
+
+__attribute__((target("avx2"))) size_t nameEndAvx2(const char* data, size_t position,
+                                                   size_t end)
+{
+    const __m256i colon = _mm256_set1_epi8(':');
+    for (; position + 32 <= end; position += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(delimiterMaskAvx2(block), _mm256_cmpeq_epi8(block, colon))));
+        if (mask != 0)
+        {
+            return position + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    return nameEndScalar(data, position, end);
+}
+
+#endif
+
+struct ScanKernels
+{
+    ScanKernel kind;
+    size_t (*lineEnd)(const char*, size_t, size_t);
+    size_t (*delimiter)(const char*, size_t, size_t);
+    size_t (*nameEnd)(const char*, size_t, size_t);
+};
+
+constexpr ScanKernels kScalarKernels{ScanKernel::Scalar, lineEndScalar, delimiterScalar,
+                                     nameEndScalar};
+
+bool cpuSupports(ScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case ScanKernel::Scalar:
+        return true;
+#ifdef BOSON_HAS_X86_SIMD
+    case ScanKernel::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case ScanKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+ScanKernels kernelsFor(ScanKernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef BOSON_HAS_X86_SIMD
+    case ScanKernel::Sse42:
+        return ScanKernels{ScanKernel::Sse42, lineEndSse42, delimiterSse42, nameEndSse42};
+    case ScanKernel::Avx2:
+        return ScanKernels{ScanKernel::Avx2, lineEndAvx2, delimiterAvx2, nameEndAvx2};
+#endif
+    default:
+        return kScalarKernels;
+    }
+}
+
+ScanKernels detectKernels()
+{
+    if (cpuSupports(ScanKernel::Avx2))
+    {
+        return kernelsFor(ScanKernel::Avx2);
+    }
+    if (cpuSupports(ScanKernel::Sse42))
+    {
+        return kernelsFor(ScanKernel::Sse42);
+    }
+    return kScalarKernels;
+}
+
+ScanKernels gKernels = detectKernels();
+
+bool equalsIgnoreCase(std::string_view value, std::string_view lowercase)
+{
+    if (value.size() != lowercase.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        if (std::tolower(static_cast<unsigned char>(value[i])) != lowercase[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+HttpParser::HttpParser(size_t maxHeaderSize, size_t maxBodySize)
+    : maxHeaderSize_(maxHeaderSize), maxBodySize_(maxBodySize)
+{
+}
+
+ScanKernel HttpParser::scanKernel()
+{
+    return gKernels.kind;
+}
+
+bool HttpParser::setScanKernel(ScanKernel kernel)
+{
+    if (!cpuSupports(kernel))
+    {
+        return false;
+    }
+    gKernels = kernelsFor(kernel);
+    return true;
+}
+
+void HttpParser::reset()
+{
+    state_ = State::RequestLineStart;
+    position_ = 0;
+    tokenStart_ = 0;
+    method_ = HttpSpan();
+    methodType_ = HttpMethod::UNKNOWN;
+    target_ = HttpSpan();
+    path_ = HttpSpan();
+    query_ = HttpSpan();
+    version_ = HttpSpan();
+    headers_.clear();
+    headerLength_ = 0;
+    contentLength_ = 0;
+}
+
+HttpParser::Status HttpParser::parse(const char* message, size_t length)
+{
+    size_t end = std::min(length, maxHeaderSize_);
+
+    while (state_ != State::Body && state_ != State::Done)
+    {
+        if (position_ >= end)
+        {
+            return position_ >= maxHeaderSize_ ? Status::HeadersTooLarge : Status::Incomplete;
+        }
+        auto c = static_cast<unsigned char>(message[position_]);
+
+        switch (state_)
+        {
+        case State::RequestLineStart:
+            // Tolerate empty lines left over from a previous request
+            if (c == '\r' || c == '\n')
+            {
+                position_++;
+                break;
+            }
+            tokenStart_ = position_;
+            state_ = State::Method;
+            break;
+
+        case State::Method:
+            while (position_ < end && isTokenChar(static_cast<unsigned char>(message[position_])))
+            {
+                position_++;
+            }
+            if (position_ == end)
+            {
+                break;
+            }
+            if (message[position_] != ' ' || position_ == tokenStart_)
+            {
+                return Status::Invalid;
+            }
+            method_ = HttpSpan{tokenStart_, position_ - tokenStart_};
+            methodType_ = httpMethodFromString(method_.in(message));
+            tokenStart_ = ++position_;
+            state_ = State::Target;
+            break;
+
+        case State::Target:
+        {
+            position_ = gKernels.delimiter(message, position_, end);
+            if (position_ == end)
+            {
+                break;
+            }
+            if (message[position_] != ' ' || position_ == tokenStart_)
+            {
+                return Status::Invalid;
+            }
+            target_ = HttpSpan{tokenStart_, position_ - tokenStart_};
+            const void* question = memchr(message + tokenStart_, '?', target_.length);
+            if (question != nullptr)
+            {
+                size_t queryStart = static_cast<size_t>(static_cast<const char*>(question) -
+                                                        message) + 1;
+                path_ = HttpSpan{tokenStart_, queryStart - 1 - tokenStart_};
+                query_ = HttpSpan{queryStart, position_ - queryStart};
+            }
+            else
+            {
+                path_ = target_;
+                query_ = HttpSpan{position_, 0};
+            }
+            tokenStart_ = ++position_;
+            state_ = State::Version;
+            break;
+        }
+
+        case State::Version:
+            position_ = gKernels.lineEnd(message, position_, end);
+            if (position_ == end)
+            {
+                break;
+            }
+            version_ = HttpSpan{tokenStart_, position_ - tokenStart_};
+            if (version_.length != 8 || version_.in(message).substr(0, 5) != "HTTP/")
+            {
+                return Status::Invalid;
+            }
+            state_ = message[position_] == '\r' ? State::RequestLineEnd : State::HeaderLineStart;
+            position_++;
+            break;
+
+        case State::RequestLineEnd:
+        case State::HeaderLineEnd:
+            if (c != '\n')
+            {
+                return Status::Invalid;
+            }
+            position_++;
+            state_ = State::HeaderLineStart;
+            break;
+
+        case State::HeaderLineStart:
+            if (c == '\r')
+            {
+                position_++;
+                state_ = State::HeadersEnd;
+            }
+            else if (c == '\n')
+            {
+                position_++;
+                Status refused = finishHeaders(message);
+                if (refused != Status::Incomplete)
+                {
+                    return refused;
+                }
+            }
+            else if (c == ' ' || c == '\t')
+            {
+                // Obsolete line folding is rejected (RFC 9112, section 5.2)
+                return Status::Invalid;
+            }
+            else
+            {
+                tokenStart_ = position_;
+                state_ = State::HeaderName;
+            }
+            break;
+
+        case State::HeaderName:
+            position_ = gKernels.nameEnd(message, position_, end);
+            if (position_ == end)
+            {
+                break;
+            }
+            if (message[position_] != ':' || position_ == tokenStart_)
+            {
+                return Status::Invalid;
+            }
+            for (size_t i = tokenStart_; i < position_; i++)
+            {
+                if (!isTokenChar(static_cast<unsigned char>(message[i])))
+                {
+                    return Status::Invalid;
+                }
+            }
+            field_.name = HttpSpan{tokenStart_, position_ - tokenStart_};
+            position_++;
+            state_ = State::HeaderValueStart;
+            break;
+
+        case State::HeaderValueStart:
+            if (c == ' ' || c == '\t')
+            {
+                position_++;
+                break;
+            }
+            tokenStart_ = position_;
+            state_ = State::HeaderValue;
+            break;
+
+        case State::HeaderValue:
+        {
+            position_ = gKernels.lineEnd(message, position_, end);
+            if (position_ == end)
+            {
+                break;
+            }
+            size_t valueEnd = position_;
+            while (valueEnd > tokenStart_ &&
+                   (message[valueEnd - 1] == ' ' || message[valueEnd - 1] == '\t'))
+            {
+                valueEnd--;
+            }
+            field_.value = HttpSpan{tokenStart_, valueEnd - tokenStart_};
+            headers_.push_back(field_);
+            state_ = message[position_] == '\r' ? State::HeaderLineEnd : State::HeaderLineStart;
+            position_++;
+            break;
+        }
+
+        case State::HeadersEnd:
+            if (c != '\n')
+            {
+                return Status::Invalid;
+            }
+            position_++;
+            {
+                Status refused = finishHeaders(message);
+                if (refused != Status::Incomplete)
+                {
+                    return refused;
+                }
+            }
+            break;
+
+        case State::Body:
+        case State::Done:
+            break;
+        }
+    }
+
+    if (state_ == State::Body && length - headerLength_ >= contentLength_)
+    {
+        state_ = State::Done;
+    }
+    return state_ == State::Done ? Status::Complete : Status::Incomplete;
+}
+
+HttpParser::Status HttpParser::finishHeaders(const char* message)
+{
+    headerLength_ = position_;
+    contentLength_ = 0;
+    state_ = State::Body;
+
+    bool seenLength = false;
+    bool seenTransferEncoding = false;
+    for (const auto& field : headers_)
+    {
+        std::string_view name = field.name.in(message);
+        if (equalsIgnoreCase(name, "transfer-encoding"))
+        {
+            seenTransferEncoding = true;
+            continue;
+        }
+        if (!equalsIgnoreCase(name, "content-length"))
+        {
+            continue;
+        }
+
+        std::string_view digits = field.value.in(message);
+        if (digits.empty())
+        {
+            return Status::Invalid;
+        }
+        size_t value = 0;
+        for (char digit : digits)
+        {
+            if (digit < '0' || digit > '9' ||
+                value > (std::numeric_limits<size_t>::max() - 9) / 10)
+            {
+                return Status::Invalid;
+            }
+            value = value * 10 + static_cast<size_t>(digit - '0');
+        }
+
+        // Conflicting lengths would let two parsers disagree on where the request ends
+        if (seenLength && value != contentLength_)
+        {
+            return Status::Invalid;
+        }
+        seenLength = true;
+        contentLength_ = value;
+    }
+
+    // Bodies are framed by Content-Length only. Framing a chunked body as empty would let its
+    // bytes be read as the next pipelined request, and a request with both headers is a
+    // classic smuggling vector (RFC 9112, section 6.3), so neither is accepted.
+    if (seenTransferEncoding)
+    {
+        contentLength_ = 0;
+        return seenLength ? Status::Invalid : Status::Unsupported;
+    }
+
+    // Refused before any of it is buffered
+    if (contentLength_ > maxBodySize_)
+    {
+        contentLength_ = 0;
+        return Status::BodyTooLarge;
+    }
+    return Status::Incomplete;
+}
+
+} // namespace boson
@@ -0,0 +1,161 @@
+#include "boson/http_status.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace boson
+{
+
+namespace
+{
+
+struct StatusReason
+{
+    int code;
+    std::string_view text;
+};
+
+constexpr StatusReason kStatusReasons[] = {
+    {100, "Continue"},
+    {101, "Switching Protocols"},
+    {200, "OK"},
+    {201, "Created"},
+    {202, "Accepted"},
+    {203, "Non-Authoritative Information"},
+    {204, "No Content"},
+    {205, "Reset Content"},
+    {206, "Partial Content"},
+    {300, "Multiple Choices"},
+    {301, "Moved Permanently"},
+    {302, "Found"},
+    {303, "See Other"},
+    {304, "Not Modified"},
+    {307, "Temporary Redirect"},
+    {308, "Permanent Redirect"},
+    {400, "Bad Request"},
+    {401, "Unauthorized"},
+    {402, "Payment Required"},
+    {403, "Forbidden"},
+    {404, "Not Found"},
+    {405, "Method Not Allowed"},
+    {406, "Not Acceptable"},
+    {407, "Proxy Authentication Required"},
+    {408, "Request Timeout"},
+    {409, "Conflict"},
+    {410, "Gone"},
+    {411, "Length Required"},
+    {412, "Precondition Failed"},
+    {413, "Payload Too Large"},
+    {414, "URI Too Long"},
+    {415, "Unsupported Media Type"},
+    {416, "Range Not Satisfiable"},
+    {417, "Expectation Failed"},
+    {418, "I'm a teapot"},
+    {421, "Misdirected Request"},
+    {422, "Unprocessable Entity"},
+    {425, "Too Early"},
+    {426, "Upgrade Required"},
+    {428, "Precondition Required"},
+    {429, "Too Many Requests"},
+    {431, "Request Header Fields Too Large"},
+    {451, "Unavailable For Legal Reasons"},
+    {500, "Internal Server Error"},
+    {501, "Not Implemented"},
+    {502, "Bad Gateway"},
+    {503, "Service Unavailable"},
+    {504, "Gateway Timeout"},
+    {505, "HTTP Version Not Supported"},
+};
+
+constexpr std::string_view kLinePrefix = "HTTP/1.1 ";
+constexpr int kMinCode = 100;
+constexpr int kMaxCode = 599;
+
+constexpr size_t statusLinesLength()
+{
+    size_t length = 0;
+    for (const StatusReason& reason : kStatusReasons)
+    {
+        // Prefix, three digits, space, reason, CRLF
+        length += kLinePrefix.size() + 4 + reason.text.size() + 2;
+    }
+    return length;
+}
+
+/**
+ * @brief Every status line laid out back to back, found through a table indexed by code
+ */
+struct StatusLines
+{
+    char bytes[statusLinesLength()] = {};
+    uint16_t offset[kMaxCode - kMinCode + 1] = {};
+    uint8_t length[kMaxCode - kMinCode + 1] = {};
+
+    constexpr std::string_view line(int code) const
+    {
+        if (code < kMinCode || code > kMaxCode)
+        {
+            return std::string_view();
+        }
+        size_t index = static_cast<size_t>(code - kMinCode);
+        return std::string_view(bytes + offset[index], length[index]);
+    }
+};
+
+constexpr StatusLines buildStatusLines()
+{
+    StatusLines lines;
+    size_t pos = 0;
+    for (const StatusReason& reason : kStatusReasons)
+    {
+        size_t start = pos;
+        for (char c : kLinePrefix)
+        {
+            lines.bytes[pos++] = c;
+        }
+        lines.bytes[pos++] = static_cast<char>('0' + reason.code / 100);
+        lines.bytes[pos++] = static_cast<char>('0' + reason.code / 10 % 10);
+        lines.bytes[pos++] = static_cast<char>('0' + reason.code % 10);
+        lines.bytes[pos++] = ' ';
+        for (char c : reason.text)
+        {
+            lines.bytes[pos++] = c;
+        }
+        lines.bytes[pos++] = '\r';
+        lines.bytes[pos++] = '\n';
+
+        size_t index = static_cast<size_t>(reason.code - kMinCode);
+        lines.offset[index] = static_cast<uint16_t>(start);
+        lines.length[index] = static_cast<uint8_t>(pos - start);
+    }
+    return lines;
+}
+
+constexpr StatusLines kStatusLines = buildStatusLines();
+
+static_assert(kStatusLines.line(200) == "HTTP/1.1 200 OK\r\n", "status line table is malformed");
+static_assert(kStatusLines.line(505) == "HTTP/1.1 505 HTTP Version Not Supported\r\n",
+              "status line table is malformed");
+static_assert(kStatusLines.line(299).empty(), "unregistered codes must have no line");
+
+} // namespace
+
+std::string_view statusLine(int code)
+{
+    return kStatusLines.line(code);
+}
+
+std::string_view statusText(int code)
+{
+    std::string_view line = kStatusLines.line(code);
+    if (line.empty())
+    {
+        return "Unknown";
+    }
+    // Drop the prefix, code and space before the reason and the CRLF after it
+    line.remove_prefix(kLinePrefix.size() + 4);
+    line.remove_suffix(2);
+    return line;
+}
+
+} // namespace boson
@@ -2,59 +2,268 @@
 #include "boson/request.hpp"
 #include "boson/response.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <regex>
 
 namespace boson
 {
 
-class NextFunction::Impl
+namespace
+{
+
+/**
+ * @brief A middleware path pattern reduced to the cheapest way of matching it
+ */
+struct CompiledPath
+{
+    enum class Kind
+    {
+        Segment, ///< The path or anything below it
+        Prefix,  ///< Any path starting with the text
+        Exact,   ///< Only the path itself
+        Glob,    ///< '*' within a segment, "**" across segments
+        Regex
+    };
+
+    Kind kind;
+    std::string text;
+    std::shared_ptr<const std::regex> regex;
+};
+
+bool hasRegexSyntax(std::string_view pattern)
+{
+    return pattern.find_first_of("()[]{}+?^$|\\") != std::string_view::npos;
+}
+
+CompiledPath compilePath(const std::string& pattern)
+{
+    if (hasRegexSyntax(pattern))
+    {
+        // "^/health$" is only a literal path in regex clothing
+        if (pattern.size() >= 2 && pattern.front() == '^' && pattern.back() == '$')
+        {
+            std::string_view literal(pattern.data() + 1, pattern.size() - 2);
+            if (!hasRegexSyntax(literal) && literal.find('*') == std::string_view::npos)
+            {
+                return CompiledPath{CompiledPath::Kind::Exact, std::string(literal), nullptr};
+            }
+        }
+        try
+        {
+            return CompiledPath{CompiledPath::Kind::Regex, pattern,
+                                std::make_shared<const std::regex>(pattern)};
+        }
+        catch (const std::regex_error&)
+        {
+            throw std::invalid_argument("Invalid middleware path pattern: " + pattern);
+        }
+    }
+
+    size_t star = pattern.find('*');
+    if (star == std::string::npos)
+    {
+        size_t end = pattern.size();
+        while (end > 0 && pattern[end - 1] == '/')
+        {
+            end--;
+        }
+        return CompiledPath{CompiledPath::Kind::Segment, pattern.substr(0, end), nullptr};
+    }
+    if (star + 1 == pattern.size())
+    {
+        return CompiledPath{CompiledPath::Kind::Prefix, pattern.substr(0, star), nullptr};
+    }
+    return CompiledPath{CompiledPath::Kind::Glob, pattern, nullptr};
+}
+
+bool globMatches(std::string_view glob, std::string_view path)
+{
+    while (!glob.empty() && glob[0] != '*')
+    {
+        if (path.empty() || glob[0] != path[0])
+        {
+            return false;
+        }
+        glob.remove_prefix(1);
+        path.remove_prefix(1);
+    }
+    if (glob.empty())
+    {
+        return path.empty();
+    }
+
+    bool crossSegments = glob.size() > 1 && glob[1] == '*';
+    glob.remove_prefix(crossSegments ? 2 : 1);
+    for (size_t i = 0; i <= path.size(); i++)
+    {
+        if (globMatches(glob, path.substr(i)))
+        {
+            return true;
+        }
+        if (i < path.size() && path[i] == '/' && !crossSegments)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool segmentBoundary(std::string_view path, size_t length)
+{
+    return length == path.size() || path[length] == '/';
+}
+
+bool pathMatchesCompiled(const CompiledPath& compiled, std::string_view path)
+{
+    switch (compiled.kind)
+    {
+    case CompiledPath::Kind::Segment:
+        return path.substr(0, compiled.text.size()) == compiled.text &&
+               segmentBoundary(path, compiled.text.size());
+    case CompiledPath::Kind::Prefix:
+        return path.substr(0, compiled.text.size()) == compiled.text;
+    case CompiledPath::Kind::Exact:
+        return path == compiled.text;
+    case CompiledPath::Kind::Glob:
+        return globMatches(compiled.text, path);
+    case CompiledPath::Kind::Regex:
+        return std::regex_match(path.data(), path.data() + path.size(), *compiled.regex);
+    }
+    return false;
+}
+
+template <typename Children> auto findChild(Children& children, char c)
+{
+    return std::find_if(children.begin(), children.end(),
+                        [c](const std::pair<char, size_t>& child) { return child.first == c; });
+}
+
+/**
+ * @brief Indices of the chain entries that apply to a request, on the stack for short chains
+ */
+class EntryIndices
 {
   public:
-    Impl() : hasNextFlag(false), error("") {}
+    void add(size_t index)
+    {
+        if (size_ < inline_.size())
+        {
+            inline_[size_] = index;
+        }
+        else
+        {
+            if (overflow_.empty())
+            {
+                overflow_.assign(inline_.begin(), inline_.end());
+            }
+            overflow_.push_back(index);
+        }
+        size_++;
+    }
+
+    void add(const std::vector<size_t>& indices)
+    {
+        for (size_t index : indices)
+        {
+            add(index);
+        }
+    }
 
-    Middleware nextMiddleware;
-    bool hasNextFlag;
-    std::string error;
-    const Request* request;
-    Response* response;
+    size_t* begin() { return size_ <= inline_.size() ? inline_.data() : overflow_.data(); }
+    size_t* end() { return begin() + size_; }
+
+  private:
+    std::array<size_t, 32> inline_;
+    std::vector<size_t> overflow_;
+    size_t size_ = 0;
 };
 
-NextFunction::NextFunction() : pimpl(std::make_unique<Impl>()) {}
+} // namespace
+
+NextFunction::NextFunction()
+    : request_(nullptr), response_(nullptr), chain_(nullptr), remaining_(0), completed_(nullptr)
+{
+}
 
 NextFunction::~NextFunction() {}
 
 void NextFunction::operator()()
 {
-    if (pimpl->hasNextFlag && pimpl->request && pimpl->response)
+    if (chain_)
     {
-        pimpl->nextMiddleware(*pimpl->request, *pimpl->response, *this);
+        // Driven by run(): hand over to the following layer, or report the chain complete
+        if (response_->sent())
+        {
+            return;
+        }
+        if (remaining_ <= 1)
+        {
+            *completed_ = true;
+            return;
+        }
+
+        NextFunction next;
+        next.request_ = request_;
+        next.response_ = response_;
+        next.chain_ = chain_ + 1;
+        next.remaining_ = remaining_ - 1;
+        next.completed_ = completed_;
+        (*next.chain_[0])(*request_, *response_, next);
+        return;
+    }
+
+    if (nextMiddleware_ && request_ && response_)
+    {
+        nextMiddleware_(*request_, *response_, *this);
     }
 }
 
 void NextFunction::operator()(const std::string& error)
 {
-    pimpl->error = error;
+    error_ = error;
     (*this)();
 }
 
 void NextFunction::setNext(const Middleware& middleware)
 {
-    pimpl->nextMiddleware = middleware;
-    pimpl->hasNextFlag = true;
+    nextMiddleware_ = middleware;
 }
 
 bool NextFunction::hasNext() const
 {
-    return pimpl->hasNextFlag;
+    return chain_ ? remaining_ > 1 : static_cast<bool>(nextMiddleware_);
 }
 
 void NextFunction::setRequestResponse(const Request& req, Response& res)
 {
-    pimpl->request = &req;
-    pimpl->response = &res;
+    request_ = &req;
+    response_ = &res;
+}
+
+bool NextFunction::run(const Middleware* const* chain, size_t count, const Request& req,
+                       Response& res)
+{
+    if (count == 0)
+    {
+        return !res.sent();
+    }
+
+    bool completed = false;
+    if (!res.sent())
+    {
+        NextFunction next;
+        next.request_ = &req;
+        next.response_ = &res;
+        next.chain_ = chain;
+        next.remaining_ = count;
+        next.completed_ = &completed;
+        (*chain[0])(req, res, next);
+    }
+    return completed && !res.sent();
 }
 
 MiddlewareChain::MiddlewareChain() {}
@@ -64,31 +273,73 @@ MiddlewareChain::~MiddlewareChain() {}
 void MiddlewareChain::add(const Middleware& middleware)
 {
     chain.emplace_back(middleware);
+    prefixNodes[0].anyEntries.push_back(chain.size() - 1);
 }
 
 void MiddlewareChain::add(const std::string& path, const Middleware& middleware)
 {
     chain.emplace_back(middleware, path);
+    try
+    {
+        compile(chain.size() - 1);
+    }
+    catch (...)
+    {
+        chain.pop_back();
+        throw;
+    }
+}
+
+void MiddlewareChain::compile(size_t entry)
+{
+    CompiledPath compiled = compilePath(*chain[entry].path);
+    switch (compiled.kind)
+    {
+    case CompiledPath::Kind::Segment:
+        prefixNodes[prefixNode(compiled.text)].segmentEntries.push_back(entry);
+        break;
+    case CompiledPath::Kind::Prefix:
+        prefixNodes[prefixNode(compiled.text)].anyEntries.push_back(entry);
+        break;
+    case CompiledPath::Kind::Exact:
+        prefixNodes[prefixNode(compiled.text)].exactEntries.push_back(entry);
+        break;
+    case CompiledPath::Kind::Glob:
+        patternMatchers.push_back(PatternMatcher{entry, compiled.text, nullptr});
+        break;
+    case CompiledPath::Kind::Regex:
+        patternMatchers.push_back(PatternMatcher{entry, std::string(), compiled.regex});
+        break;
+    }
+}
+
+size_t MiddlewareChain::prefixNode(std::string_view literal)
+{
+    size_t node = 0;
+    for (char c : literal)
+    {
+        auto& children = prefixNodes[node].children;
+        auto it = findChild(children, c);
+        if (it != children.end())
+        {
+            node = it->second;
+            continue;
+        }
+        prefixNodes.emplace_back();
+        prefixNodes[node].children.emplace_back(c, prefixNodes.size() - 1);
+        node = prefixNodes.size() - 1;
+    }
+    return node;
 }
 
 bool MiddlewareChain::pathMatches(const std::string& pattern, const std::string& path)
 {
-    // Simple path matching
-    if (pattern == path) {
-        return true;
+    try
+    {
+        return pathMatchesCompiled(compilePath(pattern), path);
     }
-    
-    // Check for wildcard prefix match (e.g., "/api/*")
-    if (pattern.length() > 0 && pattern.back() == '*') {
-        std::string prefix = pattern.substr(0, pattern.length() - 1);
-        return path.compare(0, prefix.length(), prefix) == 0;
-    }
-    
-    // Regex-based path matching
-    try {
-        std::regex pathRegex(pattern);
-        return std::regex_match(path, pathRegex);
-    } catch (const std::regex_error& e) {
+    catch (const std::invalid_argument&)
+    {
         return false;
     }
 }
@@ -100,39 +351,56 @@ bool MiddlewareChain::execute(const Request& req, Response& res)
         return true;
     }
 
-    const std::string& requestPath = req.path();
-    std::vector<Middleware> applicableMiddleware;
-    
-    for (const auto& entry : chain) {
-        if (!entry.path.has_value() || pathMatches(entry.path.value(), requestPath)) {
-            applicableMiddleware.push_back(entry.middleware);
+    // Walk the trie along the path, collecting literal patterns that match, so their number
+    // does not affect the cost; only globs and regexes are tried one by one
+    std::string_view path = req.pathView();
+    EntryIndices matched;
+    size_t node = 0;
+    for (size_t depth = 0;; depth++)
+    {
+        const PrefixNode& current = prefixNodes[node];
+        matched.add(current.anyEntries);
+        if (!current.segmentEntries.empty() && segmentBoundary(path, depth))
+        {
+            matched.add(current.segmentEntries);
         }
+        if (depth == path.size())
+        {
+            matched.add(current.exactEntries);
+            break;
+        }
+
+        char c = path[depth];
+        auto it = findChild(current.children, c);
+        if (it == current.children.end())
+        {
+            break;
+        }
+        node = it->second;
     }
-    
-    if (applicableMiddleware.empty()) {
-        return true;
-    }
-    
-    size_t index = 0;
-    
-    std::function<void(void)> runMiddleware = [&]() {
-        if (index >= applicableMiddleware.size() || res.sent()) {
-            return;
+
+    for (const auto& matcher : patternMatchers)
+    {
+        bool matches = matcher.regex ? std::regex_match(path.data(), path.data() + path.size(),
+                                                        *matcher.regex)
+                                     : globMatches(matcher.glob, path);
+        if (matches)
+        {
+            matched.add(matcher.entry);
         }
-        
-        NextFunction next;
-        next.setNext([&](const Request& r, Response& s, NextFunction& n) {
-            index++;
-            runMiddleware();
-        });
-        next.setRequestResponse(req, res);
-        
-        applicableMiddleware[index](req, res, next);
-    };
-    
-    runMiddleware();
-    
+    }
+
+    // Middleware runs in the order it was added, wherever it was found
+    std::sort(matched.begin(), matched.end());
+    MiddlewareSelection applicableMiddleware;
+    for (size_t index : matched)
+    {
+        applicableMiddleware.add(chain[index].middleware);
+    }
+
+    applicableMiddleware.run(req, res);
+
     return !res.sent();
 }
 
-} // namespace boson
\ No newline at end of file
+} // namespace boson
@@ -1,360 +1,713 @@
 #include "boson/request.hpp"
 #include "../include/external/json.hpp"
+#include "boson/error_handler.hpp"
+#include "boson/request_arena.hpp"
+#include "boson/request_pool.hpp"
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <map>
 #include <memory>
-#include <regex>
-#include <sstream>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
 namespace boson
 {
 
+namespace
+{
+
+/// Largest buffer a reset request keeps for reuse
+constexpr size_t kMaxRetainedBytes = 64 * 1024;
+
+std::string_view trimSpace(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    return text.substr(first, text.find_last_not_of(" \t") + 1 - first);
+}
+
+/**
+ * @brief Find the boundary parameter of a multipart/form-data Content-Type
+ * @return The boundary without quotes, empty for any other content type
+ */
+std::string_view multipartBoundary(std::string_view contentType)
+{
+    if (contentType.find("multipart/form-data") == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    size_t pos = contentType.find("boundary=");
+    if (pos == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    pos += 9;
+    if (pos < contentType.size() && contentType[pos] == '"')
+    {
+        size_t endQuote = contentType.find('"', pos + 1);
+        return endQuote == std::string_view::npos
+                   ? std::string_view()
+                   : contentType.substr(pos + 1, endQuote - pos - 1);
+    }
+    return trimSpace(contentType.substr(pos, contentType.find(';', pos) - pos));
+}
+
+/**
+ * @brief Find a parameter such as name or filename in a Content-Disposition value
+ * @return The value without quotes, empty if the parameter is absent
+ */
+std::string_view dispositionParam(std::string_view disposition, std::string_view name)
+{
+    size_t pos = disposition.find(';');
+    while (pos != std::string_view::npos)
+    {
+        size_t equals = disposition.find('=', pos + 1);
+        if (equals == std::string_view::npos)
+        {
+            break;
+        }
+        std::string_view key = trimSpace(disposition.substr(pos + 1, equals - pos - 1));
+        std::string_view value;
+        size_t valueStart = equals + 1;
+        if (valueStart < disposition.size() && disposition[valueStart] == '"')
+        {
+            // Quoted values may contain ';'
+            size_t endQuote = disposition.find('"', valueStart + 1);
+            if (endQuote == std::string_view::npos)
+            {
+                break;
+            }
+            value = disposition.substr(valueStart + 1, endQuote - valueStart - 1);
+            pos = disposition.find(';', endQuote);
+        }
+        else
+        {
+            pos = disposition.find(';', valueStart);
+            value = trimSpace(disposition.substr(valueStart, pos - valueStart));
+        }
+        if (headerNameEquals(key, name))
+        {
+            return value;
+        }
+    }
+    return std::string_view();
+}
+
+} // namespace
+
 class Request::Impl
 {
   public:
-    Impl() : isSecure(false) {}
-
-    std::string rawRequest;
-    std::string requestMethod;
-    std::string requestPath;
-    std::string requestQueryString;
-    std::string fullUrl;
-    std::map<std::string, std::string> requestQueryParams;
-    std::map<std::string, std::string> requestRouteParams;
-    std::map<std::string, std::string> requestHeaders;
-    std::map<std::string, std::string> requestCookies;
-    std::string requestBody;
-    std::map<std::string, std::any> customProperties;
+    explicit Impl(std::pmr::memory_resource* memory)
+        : memory(memory), rawStorage(memory), headerFields(memory), pathStorage(memory),
+          requestQueryParams(memory), extraRouteParams(memory), routeParamStorage(memory),
+          requestCookies(memory), bodyStorage(memory), customProperties(memory), isSecure(false)
+    {
+        knownHeaders.fill(kNoHeader);
+    }
+
+    // Every container draws from memory, e.g. a RequestArena or a RequestPool's resource
+    std::pmr::memory_resource* memory;
+
+    // Views point into rawRequest, which refers either to rawStorage or to the server's
+    // connection buffer; owned strings are only created when an accessor asks for one
+    std::pmr::string rawStorage;
+    std::string_view rawRequest;
+    std::string_view requestMethod;
+    HttpMethod methodType = HttpMethod::UNKNOWN;
+    std::string_view requestPath;
+    std::string_view requestQueryString;
+    std::string_view requestVersion;
+    std::string_view fullUrl;
+    std::pmr::vector<HttpHeaderField> headerFields;
+    // Index into headerFields of the first occurrence of each well-known header
+    static constexpr uint32_t kNoHeader = UINT32_MAX;
+    std::array<uint32_t, kKnownHeaderCount> knownHeaders;
+    std::pmr::string pathStorage;
+    size_t mountPrefix = 0; ///< Mount path length of the router whose route matched
+    ArenaStringMap requestQueryParams;
+    // Route parameters view the request path (or routeParamStorage); the common case of a few
+    // parameters fits inline, so routing a request does not allocate for them
+    struct RouteParam
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+    std::array<RouteParam, 8> routeParams;
+    std::pmr::vector<RouteParam> extraRouteParams;
+    size_t routeParamCount = 0;
+    ArenaStringMap routeParamStorage;
+    // Cookies view the Cookie header; names are unique, a repeated name keeps its last value
+    struct CookieField
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+    std::pmr::vector<CookieField> requestCookies;
+    std::string_view requestBody;
+    std::pmr::string bodyStorage;
+    std::pmr::map<std::pmr::string, std::any, StringViewLess> customProperties;
     std::string clientIP;
     std::string originalRequestPath;
     std::string requestProtocol;
     bool isSecure;
     std::vector<UploadedFile> uploadedFiles;
+    // Query parameters (with multipart form fields) and cookies are parsed on first access
+    bool formParsed = false;
+    bool cookiesParsed = false;
 
-    void parseMethod(const std::string& firstLine)
+    void reset()
     {
-        std::istringstream iss(firstLine);
-        iss >> requestMethod;
+        clearRetaining(rawStorage, kMaxRetainedBytes);
+        rawRequest = std::string_view();
+        requestMethod = std::string_view();
+        methodType = HttpMethod::UNKNOWN;
+        requestPath = std::string_view();
+        requestQueryString = std::string_view();
+        requestVersion = std::string_view();
+        fullUrl = std::string_view();
+        clearRetaining(headerFields, kMaxRetainedBytes);
+        knownHeaders.fill(kNoHeader);
+        clearRetaining(pathStorage, kMaxRetainedBytes);
+        mountPrefix = 0;
+        requestQueryParams.clear();
+        extraRouteParams.clear();
+        routeParamCount = 0;
+        routeParamStorage.clear();
+        clearRetaining(requestCookies, kMaxRetainedBytes);
+        requestBody = std::string_view();
+        clearRetaining(bodyStorage, kMaxRetainedBytes);
+        customProperties.clear();
+        clientIP.clear();
+        originalRequestPath.clear();
+        requestProtocol.clear();
+        isSecure = false;
+        uploadedFiles.clear();
+        formParsed = false;
+        cookiesParsed = false;
     }
 
-    void parsePath(const std::string& firstLine)
+    void adopt(std::string_view raw, const HttpParser& parser)
     {
-        std::istringstream iss(firstLine);
-        std::string method;
-        iss >> method;
-
-        std::string fullPath;
-        iss >> fullPath;
-
-        fullUrl = fullPath;
+        rawRequest = raw;
+        const char* base = raw.data();
+        requestMethod = parser.method().in(base);
+        methodType = parser.methodType();
+        fullUrl = parser.target().in(base);
+        requestPath = parser.path().in(base);
+        requestQueryString = parser.query().in(base);
+        requestVersion = parser.version().in(base);
+        headerFields.assign(parser.headers().begin(), parser.headers().end());
+        indexHeaders();
+
+        HttpSpan body = parser.body();
+        body.length = std::min(body.length, raw.size() - std::min(body.offset, raw.size()));
+        requestBody = body.offset < raw.size() ? body.in(base) : std::string_view();
+
+        requestQueryParams.clear();
+        requestCookies.clear();
+        uploadedFiles.clear();
+        formParsed = false;
+        cookiesParsed = false;
+        parseHeaders();
+    }
 
-        auto queryPos = fullPath.find('?');
-        if (queryPos != std::string::npos)
+    const ArenaStringMap& queryParams()
+    {
+        if (!formParsed)
         {
-            requestPath = fullPath.substr(0, queryPos);
-            requestQueryString = fullPath.substr(queryPos + 1);
+            formParsed = true;
             parseQueryParams();
+            parseMultipart();
         }
-        else
+        return requestQueryParams;
+    }
+
+    const std::pmr::vector<CookieField>& cookies()
+    {
+        if (!cookiesParsed)
         {
-            requestPath = fullPath;
+            cookiesParsed = true;
+            parseCookies(findHeader(KnownHeader::Cookie));
         }
+        return requestCookies;
     }
 
-    void parseQueryParams()
+    const std::vector<UploadedFile>& files()
+    {
+        queryParams();
+        return uploadedFiles;
+    }
+
+    const RouteParam& routeParamAt(size_t index) const
     {
-        std::istringstream iss(requestQueryString);
-        std::string param;
+        return index < routeParams.size() ? routeParams[index]
+                                          : extraRouteParams[index - routeParams.size()];
+    }
 
-        while (std::getline(iss, param, '&'))
+    const RouteParam* findRouteParam(std::string_view name) const
+    {
+        for (size_t i = 0; i < routeParamCount; i++)
         {
-            auto equalsPos = param.find('=');
-            if (equalsPos != std::string::npos)
+            const RouteParam& param = routeParamAt(i);
+            if (param.name == name)
             {
-                std::string key = param.substr(0, equalsPos);
-                std::string value = param.substr(equalsPos + 1);
-                requestQueryParams[key] = value;
+                return &param;
             }
-            else
+        }
+        return nullptr;
+    }
+
+    void putRouteParam(std::string_view name, std::string_view value)
+    {
+        if (auto* existing = const_cast<RouteParam*>(findRouteParam(name)))
+        {
+            *existing = RouteParam{name, value};
+            return;
+        }
+        if (routeParamCount < routeParams.size())
+        {
+            routeParams[routeParamCount] = RouteParam{name, value};
+        }
+        else
+        {
+            extraRouteParams.push_back(RouteParam{name, value});
+        }
+        routeParamCount++;
+    }
+
+    void indexHeaders()
+    {
+        knownHeaders.fill(kNoHeader);
+        for (size_t i = 0; i < headerFields.size(); i++)
+        {
+            KnownHeader header = knownHeaderFromName(headerFields[i].name.in(rawRequest.data()));
+            if (header != KnownHeader::Unknown &&
+                knownHeaders[static_cast<size_t>(header)] == kNoHeader)
             {
-                requestQueryParams[param] = "";
+                knownHeaders[static_cast<size_t>(header)] = static_cast<uint32_t>(i);
             }
         }
     }
 
-    void parseHeaders(const std::vector<std::string>& lines)
+    std::string_view findHeader(KnownHeader header) const
     {
-        for (size_t i = 1; i < lines.size(); i++)
+        if (header == KnownHeader::Unknown)
         {
-            const std::string& line = lines[i];
+            return std::string_view();
+        }
+        uint32_t index = knownHeaders[static_cast<size_t>(header)];
+        return index == kNoHeader ? std::string_view()
+                                  : headerFields[index].value.in(rawRequest.data());
+    }
 
-            if (line.empty())
+    std::string_view findHeader(std::string_view name) const
+    {
+        KnownHeader header = knownHeaderFromName(name);
+        if (header != KnownHeader::Unknown)
+        {
+            return findHeader(header);
+        }
+        for (const auto& field : headerFields)
+        {
+            if (headerNameEquals(field.name.in(rawRequest.data()), name))
             {
-                break;
+                return field.value.in(rawRequest.data());
             }
+        }
+        return std::string_view();
+    }
 
-            auto colonPos = line.find(':');
-            if (colonPos != std::string::npos)
+    void parseQueryParams()
+    {
+        size_t start = 0;
+        while (start <= requestQueryString.size())
+        {
+            size_t end = requestQueryString.find('&', start);
+            if (end == std::string_view::npos)
             {
-                std::string key = line.substr(0, colonPos);
-
-                size_t valueStart = colonPos + 1;
-                while (valueStart < line.size() && std::isspace(line[valueStart]))
+                end = requestQueryString.size();
+            }
+            std::string_view param = requestQueryString.substr(start, end - start);
+            if (!param.empty())
+            {
+                auto equalsPos = param.find('=');
+                if (equalsPos != std::string_view::npos)
                 {
-                    valueStart++;
-                }
-
-                std::string value = line.substr(valueStart);
-                requestHeaders[key] = value;
-
-                if (key == "X-Forwarded-Proto" && value == "https") {
-                    requestProtocol = "https";
-                    isSecure = true;
+                    putString(requestQueryParams, param.substr(0, equalsPos),
+                              param.substr(equalsPos + 1));
                 }
-                
-                if (key == "Cookie") {
-                    parseCookies(value);
+                else
+                {
+                    putString(requestQueryParams, param, "");
                 }
             }
-        }
-        
-        if (requestProtocol.empty()) {
-            requestProtocol = "http";
+            start = end + 1;
         }
     }
 
-    void parseCookies(const std::string& cookieHeader) {
-        std::istringstream iss(cookieHeader);
-        std::string cookiePair;
-        
-        std::string cookieStr = cookieHeader;
-        size_t pos = 0;
-        std::string delimiter = ";";
-        
-        while ((pos = cookieStr.find(delimiter)) != std::string::npos) {
-            std::string token = cookieStr.substr(0, pos);
-            parseCookiePair(token);
-            cookieStr.erase(0, pos + delimiter.length());
-        }
-        
-        if (!cookieStr.empty()) {
-            parseCookiePair(cookieStr);
-        }
-    }
-    
-    void parseCookiePair(const std::string& pair) {
-        std::string trimmed = pair;
-        trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-        trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
-        
-        size_t equalsPos = trimmed.find('=');
-        if (equalsPos != std::string::npos) {
-            std::string name = trimmed.substr(0, equalsPos);
-            std::string value = trimmed.substr(equalsPos + 1);
-            requestCookies[name] = value;
+    void parseHeaders()
+    {
+        if (findHeader("X-Forwarded-Proto") == "https") {
+            requestProtocol = "https";
+            isSecure = true;
+        } else {
+            requestProtocol = "http";
         }
     }
 
-    void parseBody(const std::vector<std::string>& lines)
+    void parseCookies(std::string_view cookieHeader)
     {
-        size_t headerEnd = 0;
-        for (size_t i = 0; i < lines.size(); ++i) {
-            if (lines[i].empty()) {
-                headerEnd = i;
+        while (!cookieHeader.empty())
+        {
+            size_t end = cookieHeader.find(';');
+            parseCookiePair(cookieHeader.substr(0, end));
+            if (end == std::string_view::npos)
+            {
                 break;
             }
+            cookieHeader.remove_prefix(end + 1);
         }
+    }
 
-        if (headerEnd == 0 || headerEnd >= lines.size() - 1) {
-            requestBody = "";
+    void parseCookiePair(std::string_view pair)
+    {
+        size_t first = pair.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+        {
             return;
         }
+        pair = pair.substr(first, pair.find_last_not_of(" \t") + 1 - first);
 
-        size_t expectedLength = 0;
-        auto it = requestHeaders.find("Content-Length");
-        if (it != requestHeaders.end()) {
-            try {
-                expectedLength = std::stoul(it->second);
-            } catch(...) {
+        size_t equalsPos = pair.find('=');
+        if (equalsPos != std::string_view::npos)
+        {
+            std::string_view name = pair.substr(0, equalsPos);
+            std::string_view value = pair.substr(equalsPos + 1);
+            for (auto& cookie : requestCookies)
+            {
+                if (cookie.name == name)
+                {
+                    cookie.value = value;
+                    return;
+                }
             }
+            requestCookies.push_back(CookieField{name, value});
+        }
+    }
+
+    void parseMultipart()
+    {
+        std::string_view boundary = multipartBoundary(findHeader(KnownHeader::ContentType));
+        if (boundary.empty() || requestBody.empty())
+        {
+            return;
         }
+        std::pmr::string delimiter("--", memory);
+        delimiter.append(boundary.data(), boundary.size());
 
-        if (!rawRequest.empty()) {
-            size_t bodyStart = rawRequest.find("\r\n\r\n");
-            if (bodyStart != std::string::npos) {
-                bodyStart += 4;
-                requestBody = rawRequest.substr(bodyStart);
+        std::string_view body = requestBody;
+        size_t start = body.find(delimiter);
+        while (start != std::string_view::npos)
+        {
+            start += delimiter.size();
+            if (body.compare(start, 2, "--") == 0)
+            {
+                break;
             }
-        } else {
-            std::stringstream bodyStream;
-            for (size_t i = headerEnd + 1; i < lines.size(); ++i) {
-                bodyStream << lines[i] << "\r\n";
+            if (body.compare(start, 2, "\r\n") == 0)
+            {
+                start += 2;
+            }
+            size_t next = body.find(delimiter, start);
+            if (next == std::string_view::npos)
+            {
+                break;
             }
-            requestBody = bodyStream.str();
+            // The CRLF before a delimiter belongs to the delimiter
+            if (next >= start + 2)
+            {
+                parsePart(body.substr(start, next - 2 - start));
+            }
+            start = next;
         }
-        
-        auto contentTypeIt = requestHeaders.find("Content-Type");
-        if (contentTypeIt != requestHeaders.end() && contentTypeIt->second.find("multipart/form-data") != std::string::npos) {
-            std::string contentType = contentTypeIt->second;
-            std::string boundary;
-            
-            std::string::size_type pos = contentType.find("boundary=");
-            if (pos != std::string::npos) {
-                pos += 9;
-                
-                if (pos < contentType.length() && contentType[pos] == '"') {
-                    pos++;
-                    size_t endQuote = contentType.find('"', pos);
-                    if (endQuote != std::string::npos) {
-                        boundary = "--" + contentType.substr(pos, endQuote - pos);
-                    }
-                } else {
-                    size_t endPos = contentType.find(';', pos);
-                    if (endPos == std::string::npos) {
-                        endPos = contentType.length();
-                    }
-                    boundary = "--" + contentType.substr(pos, endPos - pos);
-                }
-                
-                boundary.erase(std::remove_if(boundary.begin(), boundary.end(), 
-                    [](unsigned char c) { return std::isspace(c) || c == '"'; }), boundary.end());
+    }
+
+    void parsePart(std::string_view part)
+    {
+        size_t headerEnd = part.find("\r\n\r\n");
+        if (headerEnd == std::string_view::npos)
+        {
+            return;
+        }
+        std::string_view headerBlock = part.substr(0, headerEnd);
+        std::string_view data = part.substr(headerEnd + 4);
+
+        std::string_view disposition;
+        std::string_view contentType;
+        while (!headerBlock.empty())
+        {
+            size_t lineEnd = headerBlock.find("\r\n");
+            std::string_view line = headerBlock.substr(0, lineEnd);
+            headerBlock.remove_prefix(lineEnd == std::string_view::npos ? headerBlock.size()
+                                                                        : lineEnd + 2);
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos)
+            {
+                continue;
             }
-            
-            if (boundary.empty()) {
-                return;
+            std::string_view name = trimSpace(line.substr(0, colon));
+            if (headerNameEquals(name, "Content-Disposition"))
+            {
+                disposition = trimSpace(line.substr(colon + 1));
             }
-            
-            std::string body = requestBody;
-            std::string endBoundary = boundary + "--";
-            
-            size_t start = 0;
-            while (true) {
-                size_t partStart = body.find(boundary, start);
-                if (partStart == std::string::npos) break;
-                
-                partStart += boundary.size();
-                
-                if (partStart + 2 <= body.size() && body.compare(partStart, 2, "--") == 0) break;
-                
-                if (partStart + 2 <= body.size() && body.compare(partStart, 2, "\r\n") == 0) partStart += 2;
-                
-                size_t partEnd = body.find(boundary, partStart);
-                if (partEnd == std::string::npos) break;
-                
-                std::string part = body.substr(partStart, partEnd - partStart - 2);
-                
-                size_t headerEnd = part.find("\r\n\r\n");
-                if (headerEnd == std::string::npos) { 
-                    start = partEnd;
-                    continue; 
-                }
-                
-                std::string headerBlock = part.substr(0, headerEnd);
-                std::string dataBlock = part.substr(headerEnd + 4);
-                
-                std::map<std::string, std::string> partHeaders;
-                std::istringstream headerStream(headerBlock);
-                std::string headerLine;
-                while (std::getline(headerStream, headerLine)) {
-                    if (!headerLine.empty() && headerLine.back() == '\r') headerLine.pop_back();
-                    if (headerLine.empty()) continue;
-                    
-                    size_t colon = headerLine.find(":");
-                    if (colon != std::string::npos) {
-                        std::string key = headerLine.substr(0, colon);
-                        std::string value = headerLine.substr(colon + 1);
-                        while (!value.empty() && std::isspace(value.front())) value.erase(0, 1);
-                        partHeaders[key] = value;
-                    }
-                }
-                
-                auto cdIt = partHeaders.find("Content-Disposition");
-                if (cdIt != partHeaders.end()) {
-                    std::string cd = cdIt->second;
-                    
-                    std::regex nameRe("name=\"([^\"]+)\"");
-                    std::regex fnRe("filename=\"([^\"]*)\"");
-                    std::smatch nameMatch, fnMatch;
-                    std::string fieldName, fileName;
-                    
-                    if (std::regex_search(cd, nameMatch, nameRe)) fieldName = nameMatch[1];
-                    if (std::regex_search(cd, fnMatch, fnRe)) fileName = fnMatch[1];
-                    
-                    if (!fileName.empty()) {
-                        UploadedFile file;
-                        file.fieldName = fieldName;
-                        file.fileName = fileName;
-                        file.contentType = partHeaders.count("Content-Type") ? partHeaders["Content-Type"] : "application/octet-stream";
-                        file.size = dataBlock.size();
-                        file.data.assign(dataBlock.begin(), dataBlock.end());
-                        
-                        uploadedFiles.push_back(std::move(file));
-                    } else {
-                        requestQueryParams[fieldName] = dataBlock;
-                    }
-                }
-                
-                start = partEnd;
+            else if (headerNameEquals(name, knownHeaderName(KnownHeader::ContentType)))
+            {
+                contentType = trimSpace(line.substr(colon + 1));
             }
         }
+        if (disposition.empty())
+        {
+            return;
+        }
+
+        std::string_view fieldName = dispositionParam(disposition, "name");
+        std::string_view fileName = dispositionParam(disposition, "filename");
+        if (!fileName.empty())
+        {
+            UploadedFile file;
+            file.fieldName = std::string(fieldName);
+            file.fileName = std::string(fileName);
+            file.contentType =
+                contentType.empty() ? "application/octet-stream" : std::string(contentType);
+            file.size = data.size();
+            file.data.assign(data.begin(), data.end());
+            uploadedFiles.push_back(std::move(file));
+        }
+        else if (!fieldName.empty())
+        {
+            putString(requestQueryParams, fieldName, data);
+        }
     }
 };
 
-Request::Request() : pimpl(std::make_unique<Impl>()) {}
+Request::Request() : Request(std::pmr::get_default_resource()) {}
+
+Request::Request(std::pmr::memory_resource* memory)
+    : pimpl(new (memory->allocate(sizeof(Impl), alignof(Impl))) Impl(memory))
+{
+}
+
+void Request::ImplDeleter::operator()(Impl* impl) const
+{
+    std::pmr::memory_resource* memory = impl->memory;
+    impl->~Impl();
+    memory->deallocate(impl, sizeof(Impl), alignof(Impl));
+}
 
 Request::~Request() {}
 
 std::string Request::method() const
+{
+    return std::string(pimpl->requestMethod);
+}
+
+std::string_view Request::methodView() const
 {
     return pimpl->requestMethod;
 }
 
+HttpMethod Request::methodType() const
+{
+    return pimpl->methodType;
+}
+
 std::string Request::path() const
 {
-    return pimpl->requestPath;
+    return std::string(pathView());
+}
+
+std::string_view Request::pathView() const
+{
+    // The full path is never rewritten; a mounted route's handlers see the part below it
+    std::string_view full = pimpl->requestPath;
+    size_t prefix = pimpl->mountPrefix;
+    if (prefix == 0)
+    {
+        return full;
+    }
+    if (prefix < full.size() && full[prefix] == '/')
+    {
+        return full.substr(prefix);
+    }
+    // The mount point itself, with or without a trailing slash
+    return "/";
+}
+
+std::string Request::httpVersion() const
+{
+    return std::string(pimpl->requestVersion);
+}
+
+std::string_view Request::httpVersionView() const
+{
+    return pimpl->requestVersion;
 }
 
 std::string Request::queryString() const
+{
+    return std::string(pimpl->requestQueryString);
+}
+
+std::string_view Request::queryStringView() const
 {
     return pimpl->requestQueryString;
 }
 
 std::string Request::query(const std::string& name) const
 {
-    auto it = pimpl->requestQueryParams.find(name);
-    return (it != pimpl->requestQueryParams.end()) ? it->second : "";
+    const ArenaStringMap& params = pimpl->queryParams();
+    auto it = params.find(name);
+    return (it != params.end()) ? std::string(it->second) : std::string();
 }
 
 std::map<std::string, std::string> Request::queryParams() const
 {
-    return pimpl->requestQueryParams;
+    return toStdMap(pimpl->queryParams());
 }
 
 std::string Request::param(const std::string& name) const
 {
-    auto it = pimpl->requestRouteParams.find(name);
-    return (it != pimpl->requestRouteParams.end()) ? it->second : "";
+    return std::string(paramView(name));
+}
+
+std::string_view Request::paramView(std::string_view name) const
+{
+    const Impl::RouteParam* param = pimpl->findRouteParam(name);
+    return param ? param->value : std::string_view();
 }
 
+namespace
+{
+
+template <typename T> bool convertParam(std::string_view text, T& value)
+{
+    if constexpr (std::is_same<T, std::string_view>::value)
+    {
+        value = text;
+        return true;
+    }
+    else if constexpr (std::is_same<T, std::string>::value)
+    {
+        value.assign(text.data(), text.size());
+        return true;
+    }
+    else if constexpr (std::is_same<T, bool>::value)
+    {
+        value = text == "true" || text == "1";
+        return value || text == "false" || text == "0";
+    }
+    else
+    {
+        const char* end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, value);
+        return !text.empty() && result.ec == std::errc() && result.ptr == end;
+    }
+}
+
+} // namespace
+
+template <typename T> T Request::param(std::string_view name) const
+{
+    const Impl::RouteParam* param = pimpl->findRouteParam(name);
+    if (!param)
+    {
+        throw BadRequestError("Missing route parameter: " + std::string(name));
+    }
+    T value{};
+    if (!convertParam(param->value, value))
+    {
+        throw BadRequestError("Invalid route parameter " + std::string(name) + ": " +
+                              std::string(param->value));
+    }
+    return value;
+}
+
+template <typename T> T Request::param(std::string_view name, T fallback) const
+{
+    const Impl::RouteParam* param = pimpl->findRouteParam(name);
+    T value{};
+    return param && convertParam(param->value, value) ? value : fallback;
+}
+
+#define BOSON_INSTANTIATE_PARAM(T)                                                                 \
+    template T Request::param<T>(std::string_view) const;                                          \
+    template T Request::param<T>(std::string_view, T) const;
+
+BOSON_INSTANTIATE_PARAM(short)
+BOSON_INSTANTIATE_PARAM(int)
+BOSON_INSTANTIATE_PARAM(long)
+BOSON_INSTANTIATE_PARAM(long long)
+BOSON_INSTANTIATE_PARAM(unsigned short)
+BOSON_INSTANTIATE_PARAM(unsigned int)
+BOSON_INSTANTIATE_PARAM(unsigned long)
+BOSON_INSTANTIATE_PARAM(unsigned long long)
+BOSON_INSTANTIATE_PARAM(float)
+BOSON_INSTANTIATE_PARAM(double)
+BOSON_INSTANTIATE_PARAM(bool)
+BOSON_INSTANTIATE_PARAM(std::string)
+BOSON_INSTANTIATE_PARAM(std::string_view)
+
+#undef BOSON_INSTANTIATE_PARAM
+
 std::map<std::string, std::string> Request::params() const
 {
-    return pimpl->requestRouteParams;
+    std::map<std::string, std::string> result;
+    for (size_t i = 0; i < pimpl->routeParamCount; i++)
+    {
+        const Impl::RouteParam& param = pimpl->routeParamAt(i);
+        result[std::string(param.name)] = std::string(param.value);
+    }
+    return result;
 }
 
 std::string Request::header(const std::string& name) const
 {
-    auto it = pimpl->requestHeaders.find(name);
-    return (it != pimpl->requestHeaders.end()) ? it->second : "";
+    return std::string(pimpl->findHeader(name));
+}
+
+std::string_view Request::headerView(std::string_view name) const
+{
+    return pimpl->findHeader(name);
+}
+
+std::string_view Request::headerView(KnownHeader header) const
+{
+    return pimpl->findHeader(header);
 }
 
 std::map<std::string, std::string> Request::headers() const
 {
-    return pimpl->requestHeaders;
+    std::map<std::string, std::string> result;
+    for (const auto& field : pimpl->headerFields)
+    {
+        result[std::string(field.name.in(pimpl->rawRequest.data()))] =
+            std::string(field.value.in(pimpl->rawRequest.data()));
+    }
+    return result;
 }
 
 std::string Request::body() const
+{
+    return std::string(pimpl->requestBody);
+}
+
+std::string_view Request::bodyView() const
 {
     return pimpl->requestBody;
 }
@@ -369,7 +722,7 @@ nlohmann::json Request::json() const
 
         if (isJsonContent || !pimpl->requestBody.empty())
         {
-            return nlohmann::json::parse(pimpl->requestBody);
+            return nlohmann::json::parse(pimpl->requestBody.begin(), pimpl->requestBody.end());
         }
     }
     catch (const std::exception& e)
@@ -387,7 +740,15 @@ std::any Request::get(const std::string& name) const
 
 void Request::set(const std::string& name, std::any value)
 {
-    pimpl->customProperties[name] = value;
+    auto it = pimpl->customProperties.find(name);
+    if (it == pimpl->customProperties.end())
+    {
+        pimpl->customProperties.emplace(name, std::move(value));
+    }
+    else
+    {
+        it->second = std::move(value);
+    }
 }
 
 bool Request::has(const std::string& name) const
@@ -402,27 +763,20 @@ std::string Request::ip() const
 
 std::string Request::hostname() const
 {
-    auto it = pimpl->requestHeaders.find("Host");
-    if (it != pimpl->requestHeaders.end()) {
-        std::string host = it->second;
-        size_t colonPos = host.find(':');
-        if (colonPos != std::string::npos) {
-            return host.substr(0, colonPos);
-        }
-        return host;
-    }
-    return "";
+    std::string_view host = pimpl->findHeader(KnownHeader::Host);
+    return std::string(host.substr(0, host.find(':')));
 }
 
 std::string Request::originalUrl() const
 {
     if (!pimpl->fullUrl.empty()) {
-        return pimpl->fullUrl;
+        return std::string(pimpl->fullUrl);
     }
 
-    std::string url = pimpl->requestPath;
+    std::string url(pimpl->requestPath);
     if (!pimpl->requestQueryString.empty()) {
-        url += "?" + pimpl->requestQueryString;
+        url += "?";
+        url += pimpl->requestQueryString;
     }
     return url;
 }
@@ -439,47 +793,60 @@ bool Request::secure() const
 
 std::string Request::cookie(const std::string& name) const
 {
-    auto it = pimpl->requestCookies.find(name);
-    return (it != pimpl->requestCookies.end()) ? it->second : "";
+    for (const auto& cookie : pimpl->cookies())
+    {
+        if (cookie.name == name)
+        {
+            return std::string(cookie.value);
+        }
+    }
+    return std::string();
 }
 
 std::map<std::string, std::string> Request::cookies() const
 {
-    return pimpl->requestCookies;
+    std::map<std::string, std::string> result;
+    for (const auto& cookie : pimpl->cookies())
+    {
+        result.emplace(std::string(cookie.name), std::string(cookie.value));
+    }
+    return result;
 }
 
 void Request::setRawRequest(const std::string& rawRequest)
 {
-    pimpl->rawRequest = rawRequest;
+    pimpl->rawStorage = rawRequest;
+    pimpl->rawRequest = pimpl->rawStorage;
+    pimpl->requestCookies.clear();
+    pimpl->cookiesParsed = false;
 }
 
-void Request::setRouteParam(const std::string& name, const std::string& value)
+void Request::setParsedRequest(std::string_view rawRequest, const HttpParser& parser)
 {
-    pimpl->requestRouteParams[name] = value;
+    pimpl->rawStorage.clear();
+    pimpl->adopt(rawRequest, parser);
 }
 
-void Request::parse()
+void Request::setRouteParam(const std::string& name, const std::string& value)
 {
-    std::vector<std::string> lines;
-    std::istringstream iss(pimpl->rawRequest);
-    std::string line;
+    auto it = putString(pimpl->routeParamStorage, name, value);
+    pimpl->putRouteParam(it->first, it->second);
+}
 
-    while (std::getline(iss, line))
-    {
-        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
-        lines.push_back(line);
-    }
+void Request::addRouteParam(std::string_view name, std::string_view value)
+{
+    pimpl->putRouteParam(name, value);
+}
 
-    if (lines.empty())
+void Request::parse()
+{
+    HttpParser parser(pimpl->rawRequest.size() + 1);
+    if (parser.parse(pimpl->rawRequest.data(), pimpl->rawRequest.size()) ==
+        HttpParser::Status::Invalid)
     {
         return;
     }
-
-    pimpl->parseMethod(lines[0]);
-    pimpl->parsePath(lines[0]);
-
-    pimpl->parseHeaders(lines);
-    pimpl->parseBody(lines);
+    pimpl->adopt(pimpl->rawRequest, parser);
 }
 
 void Request::setOriginalPath(const std::string& path)
@@ -489,136 +856,38 @@ void Request::setOriginalPath(const std::string& path)
 
 void Request::overridePath(const std::string& path)
 {
-    pimpl->requestPath = path;
+    pimpl->pathStorage = path;
+    pimpl->requestPath = pimpl->pathStorage;
+    pimpl->mountPrefix = 0;
 }
 
-std::vector<UploadedFile> Request::files() const {
-    return pimpl->uploadedFiles;
+void Request::reset()
+{
+    pimpl->reset();
+}
+
+void Request::setMountPrefix(size_t prefixLength)
+{
+    pimpl->mountPrefix = prefixLength;
+}
+
+std::vector<UploadedFile> Request::files() const
+{
+    return pimpl->files();
 }
 
 void Request::setBody(const std::string& body)
 {
-    pimpl->requestBody = body;
-    
-    auto contentTypeIt = pimpl->requestHeaders.find("Content-Type");
-    if (contentTypeIt != pimpl->requestHeaders.end() && 
-        contentTypeIt->second.find("multipart/form-data") != std::string::npos) {
-        
-        std::string contentType = contentTypeIt->second;
-        std::string boundary;
-        
-        std::string::size_type pos = contentType.find("boundary=");
-        if (pos != std::string::npos) {
-            pos += 9;
-            
-            if (pos < contentType.length() && contentType[pos] == '"') {
-                pos++;
-                size_t endQuote = contentType.find('"', pos);
-                if (endQuote != std::string::npos) {
-                    boundary = "--" + contentType.substr(pos, endQuote - pos);
-                }
-            } else {
-                size_t endPos = contentType.find(';', pos);
-                if (endPos == std::string::npos) {
-                    endPos = contentType.length();
-                }
-                boundary = "--" + contentType.substr(pos, endPos - pos);
-            }
-            
-            boundary.erase(std::remove_if(boundary.begin(), boundary.end(), 
-                [](unsigned char c) { return std::isspace(c); }), boundary.end());
-        }
-        
-        if (!boundary.empty() && !body.empty()) {
-            size_t start = body.find(boundary);
-            if (start != std::string::npos) {
-                pimpl->uploadedFiles.clear();
-                
-                while (true) {
-                    start = body.find(boundary, start);
-                    if (start == std::string::npos) break;
-                    
-                    start += boundary.length();
-                    
-                    if (start + 2 <= body.size() && body.compare(start, 2, "--") == 0) {
-                        break;
-                    }
-                    
-                    if (start + 2 <= body.size() && body.compare(start, 2, "\r\n") == 0) {
-                        start += 2;
-                    }
-                    
-                    size_t nextBoundary = body.find(boundary, start);
-                    if (nextBoundary == std::string::npos) break;
-                    
-                    size_t partEndWithoutCRLF = nextBoundary - 2;
-                    if (partEndWithoutCRLF <= start) continue;
-                    
-                    std::string partContent = body.substr(start, partEndWithoutCRLF - start);
-                    
-                    size_t headerEnd = partContent.find("\r\n\r\n");
-                    if (headerEnd == std::string::npos) {
-                        start = nextBoundary;
-                        continue;
-                    }
-                    
-                    std::string headersPart = partContent.substr(0, headerEnd);
-                    std::string bodyPart = partContent.substr(headerEnd + 4);
-                    
-                    std::map<std::string, std::string> headers;
-                    std::istringstream headerStream(headersPart);
-                    std::string line;
-                    
-                    while (std::getline(headerStream, line)) {
-                        if (!line.empty() && line.back() == '\r') line.pop_back();
-                        if (line.empty()) continue;
-                        
-                        size_t colonPos = line.find(':');
-                        if (colonPos != std::string::npos) {
-                            std::string name = line.substr(0, colonPos);
-                            std::string value = line.substr(colonPos + 1);
-                            value.erase(0, value.find_first_not_of(" \t"));
-                            headers[name] = value;
-                        }
-                    }
-                    
-                    auto cdIt = headers.find("Content-Disposition");
-                    if (cdIt != headers.end()) {
-                        std::string cd = cdIt->second;
-                        
-                        std::string fieldName, fileName;
-                        
-                        std::regex nameRegex("name=\"([^\"]*)\"");
-                        std::smatch nameMatch;
-                        if (std::regex_search(cd, nameMatch, nameRegex) && nameMatch.size() > 1) {
-                            fieldName = nameMatch[1];
-                        }
-                        
-                        std::regex fileRegex("filename=\"([^\"]*)\"");
-                        std::smatch fileMatch;
-                        if (std::regex_search(cd, fileMatch, fileRegex) && fileMatch.size() > 1) {
-                            fileName = fileMatch[1];
-                        }
-                        
-                        if (!fileName.empty()) {
-                            UploadedFile file;
-                            file.fieldName = fieldName;
-                            file.fileName = fileName;
-                            file.contentType = headers.count("Content-Type") ? headers["Content-Type"] : "application/octet-stream";
-                            file.size = bodyPart.size();
-                            file.data.assign(bodyPart.begin(), bodyPart.end());
-                            
-                            pimpl->uploadedFiles.push_back(std::move(file));
-                        } else if (!fieldName.empty()) {
-                            pimpl->requestQueryParams[fieldName] = bodyPart;
-                        }
-                    }
-                    
-                    start = nextBoundary;
-                }
-            }
-        }
+    pimpl->bodyStorage = body;
+    pimpl->requestBody = pimpl->bodyStorage;
+
+    // Form fields and files come from the new body the next time they are read
+    if (pimpl->formParsed)
+    {
+        pimpl->requestQueryParams.clear();
+        pimpl->uploadedFiles.clear();
+        pimpl->formParsed = false;
     }
 }
 
-} // namespace boson
\ No newline at end of file
+} // namespace boson
@@ -0,0 +1,19 @@
+#include "boson/request_arena.hpp"
+
+namespace boson
+{
+
+RequestArena::RequestArena(size_t capacity)
+    : buffer_(std::make_unique<std::byte[]>(capacity)), memory_(buffer_.get(), capacity)
+{
+}
+
+RequestArena::~RequestArena() {}
+
+void RequestArena::reset()
+{
+    // Frees any overflow blocks and rewinds to the start of the buffer
+    memory_.release();
+}
+
+} // namespace boson
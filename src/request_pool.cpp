@@ -0,0 +1,62 @@
+#include "boson/request_pool.hpp"
+
+namespace boson
+{
+
+RequestPool::Lease::Lease(RequestPool& pool, std::unique_ptr<Request> request,
+                          std::unique_ptr<Response> response)
+    : pool_(pool), request_(std::move(request)), response_(std::move(response))
+{
+}
+
+RequestPool::Lease::~Lease()
+{
+    request_->reset();
+    response_->reset();
+    pool_.requests_.push_back(std::move(request_));
+    pool_.responses_.push_back(std::move(response_));
+}
+
+RequestPool::RequestPool()
+{
+    // One lease at a time is the common case; reserving keeps returning objects allocation-free
+    requests_.reserve(4);
+    responses_.reserve(4);
+}
+
+RequestPool::~RequestPool() {}
+
+RequestPool::Lease RequestPool::acquire()
+{
+    std::unique_ptr<Request> request;
+    if (requests_.empty())
+    {
+        request = std::make_unique<Request>(&memory_);
+    }
+    else
+    {
+        request = std::move(requests_.back());
+        requests_.pop_back();
+    }
+
+    std::unique_ptr<Response> response;
+    if (responses_.empty())
+    {
+        response = std::make_unique<Response>(&memory_);
+    }
+    else
+    {
+        response = std::move(responses_.back());
+        responses_.pop_back();
+    }
+
+    return Lease(*this, std::move(request), std::move(response));
+}
+
+RequestPool& RequestPool::local()
+{
+    thread_local RequestPool pool;
+    return pool;
+}
+
+} // namespace boson
@@ -1,11 +1,22 @@
 #include "boson/response.hpp"
 #include "../include/external/json.hpp"
+#include "boson/compression.hpp"
 #include "boson/cookie.hpp"
+#include "boson/file_watcher.hpp"
+#include "boson/http_date.hpp"
+#include "boson/http_headers.hpp"
+#include "boson/http_status.hpp"
+#include "boson/request_arena.hpp"
+#include "boson/request_pool.hpp"
 
+#include <charconv>
 #include <map>
 #include <memory>
-#include <sstream>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 #include <chrono>
@@ -15,117 +26,626 @@
 #include <stdexcept>
 #include <iostream>
 #include <functional>
+#include <list>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BOSON_HAS_SENDFILE 1
+#endif
 
 namespace boson
 {
 
+namespace
+{
+
+/// Largest buffer a reset response keeps for reuse
+constexpr size_t kMaxRetainedBytes = 64 * 1024;
+
+template <typename String, typename Integer>
+void appendNumber(String& out, Integer value, int base = 10)
+{
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+/**
+ * @brief Format the size line that starts a chunk of a chunked body
+ */
+std::string chunkSizeLine(std::uint64_t size)
+{
+    std::string line;
+    appendNumber(line, size, 16);
+    line += "\r\n";
+    return line;
+}
+
+/**
+ * @brief What sendFile() needs to know about a file
+ */
+struct FileMetadata
+{
+    std::string absolute; ///< Normalized, to match the paths the watcher reports
+    bool regular = false;
+    std::uintmax_t size = 0;
+    std::string etag;
+    std::string lastModified;
+};
+
+/**
+ * @brief Metadata of files sent with sendFile(), kept until inotify reports a change
+ *
+ * A file's directory is watched before the file is first looked at, so no change can slip
+ * in between. Where files cannot be watched nothing is kept, and every lookup reads the
+ * metadata from disk as before.
+ */
+class FileMetadataCache
+{
+  public:
+    static FileMetadataCache& instance()
+    {
+        static FileMetadataCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Get a file's metadata
+     * @return nullptr if the file does not exist
+     */
+    std::shared_ptr<const FileMetadata> lookup(const std::string& path)
+    {
+        std::uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(path);
+            if (it != entries.end())
+            {
+                recency.splice(recency.begin(), recency, it->second.position);
+                return it->second.metadata;
+            }
+            seen = generation;
+        }
+
+        std::error_code error;
+        auto metadata = std::make_shared<FileMetadata>();
+        std::filesystem::path absolute = std::filesystem::absolute(path, error).lexically_normal();
+        bool watched = !error && watchDirectory(absolute.parent_path());
+        metadata->absolute = absolute.string();
+
+        std::filesystem::file_status status = std::filesystem::status(path, error);
+        if (error || !std::filesystem::exists(status))
+        {
+            return nullptr;
+        }
+        metadata->regular = std::filesystem::is_regular_file(status);
+        if (metadata->regular)
+        {
+            metadata->size = std::filesystem::file_size(path, error);
+            auto modified = std::filesystem::last_write_time(path, error);
+            if (error)
+            {
+                return nullptr;
+            }
+            metadata->etag = "\"" +
+                             std::to_string(static_cast<long long>(
+                                 modified.time_since_epoch().count())) +
+                             "-" + std::to_string(static_cast<uintmax_t>(metadata->size)) + "\"";
+            char date[kHttpDateLength];
+            formatHttpDate(modified, date);
+            metadata->lastModified.assign(date, kHttpDateLength);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (watched && seen == generation && !entries.count(path))
+        {
+            // Make room by dropping the least recently sent file, not the whole cache
+            if (entries.size() >= kMaxEntries)
+            {
+                entries.erase(*recency.back());
+                recency.pop_back();
+            }
+            auto inserted = entries.emplace(path, Entry{metadata, {}}).first;
+            recency.push_front(&inserted->first);
+            inserted->second.position = recency.begin();
+        }
+        return metadata;
+    }
+
+  private:
+    /// Bounds the memory kept for applications that send many different files
+    static constexpr size_t kMaxEntries = 4096;
+    /// Leaves most of the per-user inotify watch limit to the rest of the process
+    static constexpr size_t kMaxDirectories = 1024;
+
+    struct Entry
+    {
+        std::shared_ptr<const FileMetadata> metadata;
+        std::list<const std::string*>::iterator position; ///< In recency
+    };
+
+    bool watchDirectory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directories.count(directory.string()))
+        {
+            return true;
+        }
+        if (directories.size() >= kMaxDirectories ||
+            !watcher.watch(directory, false,
+                           [this](const std::filesystem::path& path, bool isDirectory) {
+                               changed(path, isDirectory);
+                           }))
+        {
+            return false;
+        }
+        directories.insert(directory.string());
+        return true;
+    }
+
+    void changed(const std::filesystem::path& path, bool isDirectory)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        std::string changedPath = path.string();
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            const std::string& entryPath = it->second.metadata->absolute;
+            bool stale = entryPath == changedPath ||
+                         (isDirectory && entryPath.size() > changedPath.size() &&
+                          entryPath.compare(0, changedPath.size(), changedPath) == 0 &&
+                          entryPath[changedPath.size()] == '/');
+            if (stale)
+            {
+                recency.erase(it->second.position);
+                it = entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    /// Keys of entries, most recently sent first
+    std::list<const std::string*> recency;
+    std::unordered_set<std::string> directories;
+    std::uint64_t generation = 0;
+    // Last, so its thread is joined before anything it touches is destroyed
+    FileWatcher watcher;
+};
+
+} // namespace
+
 class Response::Impl
 {
   public:
-    Impl() : statusCode(200), sentFlag(false), streamingEnabled(false), compressionEnabled(false) {}
+    explicit Impl(std::pmr::memory_resource* memory)
+        : memory(memory), responseHeaders(memory), responseBody(memory), statusCode(200),
+          sentFlag(false), streamingEnabled(false), cookies(memory),
+          serializedHead(memory)
+    {
+    }
+
+    ~Impl() { closeFileBody(); }
+
+    void closeFileBody()
+    {
+#ifdef BOSON_HAS_SENDFILE
+        if (fileBody.fd >= 0)
+        {
+            ::close(fileBody.fd);
+        }
+#endif
+        fileBody = FileBody();
+    }
+
+    void reset()
+    {
+        responseHeaders.clear();
+        clearRetaining(responseBody, kMaxRetainedBytes);
+        statusCode = 200;
+        sentFlag = false;
+        streamingEnabled = false;
+        compressionChoice = CompressionChoice::Automatic;
+        acceptEncoding = std::string_view();
+        automaticCompression = nullptr;
+        streamStarted = false;
+        streamEnded = false;
+        streamEncoding = ContentEncoding::Identity;
+        clearRetaining(cookies, kMaxRetainedBytes);
+        streamCallback = nullptr;
+        closeFileBody();
+        sharedBody.reset();
+        clearRetaining(serializedHead, kMaxRetainedBytes);
+    }
 
-    std::map<std::string, std::string> responseHeaders;
-    std::string responseBody;
+    // Every container draws from memory, e.g. a RequestArena or a RequestPool's resource
+    std::pmr::memory_resource* memory;
+    HeaderList responseHeaders;
+    std::pmr::string responseBody;
     int statusCode;
     bool sentFlag;
     bool streamingEnabled;
-    bool compressionEnabled;
-    std::vector<Cookie> cookies;
+    // compress() overrides the server's automatic compression in either direction
+    enum class CompressionChoice
+    {
+        Automatic,
+        On,
+        Off
+    };
+    CompressionChoice compressionChoice = CompressionChoice::Automatic;
+    std::string_view acceptEncoding;
+    const CompressionOptions* automaticCompression = nullptr;
+    bool streamStarted = false;
+    bool streamEnded = false;
+    ContentEncoding streamEncoding = ContentEncoding::Identity;
+    std::pmr::vector<Cookie> cookies;
     std::function<void(const std::string&)> streamCallback;
+    FileBody fileBody;
+    // Set by sendShared() in place of responseBody, e.g. a body held by a StaticFileCache
+    std::shared_ptr<const std::string> sharedBody;
+    std::pmr::string serializedHead;
 
-    std::string getStatusText(int code)
+    /**
+     * @brief Get the in-memory body, whichever of the two holds it
+     */
+    std::string_view body() const
     {
-        switch (code)
-        {
-        case 200:
-            return "OK";
-        case 201:
-            return "Created";
-        case 204:
-            return "No Content";
-        case 206:
-            return "Partial Content";
-        case 301:
-            return "Moved Permanently";
-        case 302:
-            return "Found";
-        case 304:
-            return "Not Modified";
-        case 307:
-            return "Temporary Redirect";
-        case 308:
-            return "Permanent Redirect";
-        case 400:
-            return "Bad Request";
-        case 401:
-            return "Unauthorized";
-        case 403:
-            return "Forbidden";
-        case 404:
-            return "Not Found";
-        case 405:
-            return "Method Not Allowed";
-        case 406:
-            return "Not Acceptable";
-        case 409:
-            return "Conflict";
-        case 413:
-            return "Payload Too Large";
-        case 415:
-            return "Unsupported Media Type";
-        case 416:
-            return "Range Not Satisfiable";
-        case 422:
-            return "Unprocessable Entity";
-        case 429:
-            return "Too Many Requests";
-        case 500:
-            return "Internal Server Error";
-        case 501:
-            return "Not Implemented";
-        case 502:
-            return "Bad Gateway";
-        case 503:
-            return "Service Unavailable";
-        default:
-            return "Unknown";
-        }
+        return sharedBody ? std::string_view(*sharedBody) : std::string_view(responseBody);
     }
 
-    std::string buildResponseString()
+    /**
+     * @brief Attach a file as the body without reading it into memory
+     * @return False if the platform has no sendfile(2) or the file cannot be opened
+     */
+    bool openFileBody(const std::filesystem::path& path, bool chunked)
     {
-        std::stringstream ss;
+#ifdef BOSON_HAS_SENDFILE
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        fileBody.fd = fd;
+        fileBody.offset = 0;
+        fileBody.length = static_cast<std::uint64_t>(st.st_size);
+        fileBody.chunked = chunked;
+        return true;
+#else
+        (void)path;
+        (void)chunked;
+        return false;
+#endif
+    }
 
-        ss << "HTTP/1.1 " << statusCode << " " << getStatusText(statusCode) << "\r\n";
+    /**
+     * @brief Read the attached file region into memory, for callers that need the bytes
+     */
+    std::string readFileBody() const
+    {
+        std::string content;
+#ifdef BOSON_HAS_SENDFILE
+        content.resize(fileBody.length);
+        size_t done = 0;
+        while (done < content.size())
+        {
+            ssize_t n = pread(fileBody.fd, &content[done], content.size() - done,
+                              static_cast<off_t>(fileBody.offset + done));
+            if (n <= 0)
+            {
+                break;
+            }
+            done += static_cast<size_t>(n);
+        }
+        content.resize(done);
+#endif
+        return content;
+    }
 
-        if (responseHeaders.find("Content-Type") == responseHeaders.end())
+    /**
+     * @brief Append the status line and headers, terminated by the blank line
+     *
+     * Fills in Date, Content-Type, Content-Length and Connection when the response has not
+     * set them, without adding them to responseHeaders. A streamed head has no Content-Length
+     * other than one the handler set, since the body length is not known yet.
+     */
+    template <typename String>
+    void writeHead(String& out, bool streamed, const HeaderBlock* defaults) const
+    {
+        std::string_view line = statusLine(statusCode);
+        if (!line.empty())
         {
-            responseHeaders["Content-Type"] = "text/plain";
+            out.append(line.data(), line.size());
+        }
+        else
+        {
+            out.append("HTTP/1.1 ");
+            appendNumber(out, statusCode);
+            out.append(" Unknown\r\n");
         }
 
-        responseHeaders["Content-Length"] = std::to_string(responseBody.length());
-        responseHeaders["Connection"] = "close";
+        if (!responseHeaders.contains(KnownHeader::Date))
+        {
+            std::string_view date = currentHttpDate();
+            out.append("Date: ");
+            out.append(date.data(), date.size());
+            out.append("\r\n");
+        }
+        if (defaults)
+        {
+            writeDefaults(out, *defaults);
+        }
 
-        // Add all headers
+        const std::pmr::string* contentLength =
+            streamed ? nullptr : responseHeaders.find(KnownHeader::ContentLength);
         for (const auto& header : responseHeaders)
         {
-            ss << header.first << ": " << header.second << "\r\n";
+            if (&header.value == contentLength)
+            {
+                continue;
+            }
+            out.append(header.name.data(), header.name.size());
+            out.append(": ");
+            out.append(header.value.data(), header.value.size());
+            out.append("\r\n");
+        }
+
+        if (!streamed && !responseHeaders.contains(KnownHeader::ContentType))
+        {
+            out.append("Content-Type: text/plain\r\n");
+        }
+        if (!responseHeaders.contains(KnownHeader::Connection))
+        {
+            out.append("Connection: close\r\n");
+        }
+        if (!streamed && !(fileBody.fd >= 0 && fileBody.chunked))
+        {
+            out.append("Content-Length: ");
+            appendNumber(out, fileBody.fd >= 0 ? fileBody.length : body().size());
+            out.append("\r\n");
         }
 
-        // Add all cookies
         for (const auto& cookie : cookies)
         {
-            ss << "Set-Cookie: " << cookie.toString() << "\r\n";
+            out.append("Set-Cookie: ");
+            out.append(cookie.toString());
+            out.append("\r\n");
         }
 
-        ss << "\r\n";
-        ss << responseBody;
+        out.append("\r\n");
+    }
 
-        return ss.str();
+    /**
+     * @brief Append default headers, leaving out any the response sets itself
+     */
+    template <typename String> void writeDefaults(String& out, const HeaderBlock& defaults) const
+    {
+        bool overridden = false;
+        for (const auto& header : defaults.headers())
+        {
+            overridden = overridden || responseHeaders.contains(header.name);
+        }
+        if (!overridden)
+        {
+            std::string_view bytes = defaults.bytes();
+            out.append(bytes.data(), bytes.size());
+            return;
+        }
+        for (const auto& header : defaults.headers())
+        {
+            if (!responseHeaders.contains(header.name))
+            {
+                out.append(header.name.data(), header.name.size());
+                out.append(": ");
+                out.append(header.value.data(), header.value.size());
+                out.append("\r\n");
+            }
+        }
+    }
+
+    /**
+     * @brief Get the options to compress this response with, or nullptr to send it as is
+     */
+    const CompressionOptions* compressionOptions(bool streamed) const
+    {
+        static const CompressionOptions defaults;
+        if (compressionChoice == CompressionChoice::Off ||
+            (compressionChoice == CompressionChoice::Automatic && !automaticCompression))
+        {
+            return nullptr;
+        }
+        const CompressionOptions* options = automaticCompression ? automaticCompression : &defaults;
+
+        // Already encoded, sent with sendfile(2) or shared, or a status whose body must stay
+        // as it is
+        if (responseHeaders.contains(KnownHeader::ContentEncoding) || fileBody.fd >= 0 ||
+            sharedBody || statusCode < 200 || statusCode == 204 || statusCode == 206 || statusCode == 304)
+        {
+            return nullptr;
+        }
+        if (compressionChoice == CompressionChoice::Automatic)
+        {
+            const std::pmr::string* contentType = responseHeaders.find(KnownHeader::ContentType);
+            if (!options->compressible(contentType ? std::string_view(*contentType)
+                                                   : std::string_view("text/plain")))
+            {
+                return nullptr;
+            }
+        }
+        if (!streamed && responseBody.size() < options->minSize)
+        {
+            return nullptr;
+        }
+        return options;
+    }
+
+    /**
+     * @brief Mark the response as depending on Accept-Encoding, for caches
+     */
+    void varyOnAcceptEncoding()
+    {
+        constexpr std::string_view kAcceptEncoding = "Accept-Encoding";
+        const std::pmr::string* vary = responseHeaders.find(KnownHeader::Vary);
+        if (!vary)
+        {
+            responseHeaders.set(KnownHeader::Vary, kAcceptEncoding);
+        }
+        else if (vary->find(kAcceptEncoding) == std::pmr::string::npos && *vary != "*")
+        {
+            std::string value(*vary);
+            value += ", ";
+            value += kAcceptEncoding;
+            responseHeaders.set(KnownHeader::Vary, value);
+        }
+    }
+
+    /**
+     * @brief Compress the buffered body with the coding the client prefers
+     */
+    void compressBody()
+    {
+        const CompressionOptions* options = compressionOptions(false);
+        if (!options)
+        {
+            return;
+        }
+        varyOnAcceptEncoding();
+        ContentEncoding encoding = options->negotiate(acceptEncoding);
+        if (encoding == ContentEncoding::Identity)
+        {
+            return;
+        }
+
+        thread_local std::string compressed;
+        bool smaller = Compressor::local().compress(encoding, responseBody, compressed,
+                                                    options->level) &&
+                       compressed.size() < responseBody.size();
+        if (smaller)
+        {
+            responseBody.assign(compressed.data(), compressed.size());
+            responseHeaders.set(KnownHeader::ContentEncoding, contentEncodingName(encoding));
+        }
+        clearRetaining(compressed, kMaxRetainedBytes);
+    }
+
+    /**
+     * @brief Send one chunk of a streamed body, compressing it first if the stream is
+     *
+     * The first chunk decides the stream's coding and its chunked framing, before the
+     * callback sends the head. Each call hands the callback one buffer holding the size line,
+     * the data and the terminator.
+     */
+    void sendChunk(std::string_view data, bool last)
+    {
+        if (!streamStarted)
+        {
+            streamStarted = true;
+            // Without it the server could only delimit the body by closing the connection
+            responseHeaders.set(KnownHeader::TransferEncoding, "chunked");
+            responseHeaders.erase(knownHeaderName(KnownHeader::ContentLength));
+            const CompressionOptions* options = compressionOptions(true);
+            if (options)
+            {
+                varyOnAcceptEncoding();
+                ContentEncoding encoding = options->negotiate(acceptEncoding);
+                if (encoding != ContentEncoding::Identity &&
+                    Compressor::local().begin(encoding, options->level))
+                {
+                    streamEncoding = encoding;
+                    responseHeaders.set(KnownHeader::ContentEncoding,
+                                        contentEncodingName(encoding));
+                }
+            }
+        }
+
+        thread_local std::string compressed;
+        thread_local std::string chunk;
+        if (streamEncoding != ContentEncoding::Identity)
+        {
+            compressed.clear();
+            Compressor::local().write(data, compressed, last);
+            data = compressed;
+            if (last)
+            {
+                streamEncoding = ContentEncoding::Identity;
+            }
+        }
+
+        chunk.clear();
+        // An empty chunk would end the body early
+        if (!data.empty())
+        {
+            appendNumber(chunk, data.size(), 16);
+            chunk += "\r\n";
+            chunk += data;
+            chunk += "\r\n";
+        }
+        if (last)
+        {
+            chunk += "0\r\n\r\n";
+            streamEnded = true;
+        }
+        if (!chunk.empty())
+        {
+            streamCallback(chunk);
+        }
+        clearRetaining(compressed, kMaxRetainedBytes);
+        clearRetaining(chunk, kMaxRetainedBytes);
+    }
+
+    std::string buildResponseString()
+    {
+        std::string response;
+        writeHead(response, false, nullptr);
+        if (fileBody.fd < 0)
+        {
+            response += body();
+            return response;
+        }
+
+        std::string content = readFileBody();
+        if (fileBody.chunked)
+        {
+            if (!content.empty())
+            {
+                response += chunkSizeLine(content.size());
+                response += content;
+                response += "\r\n";
+            }
+            response += "0\r\n\r\n";
+        }
+        else
+        {
+            response += content;
+        }
+        return response;
     }
 };
 
-Response::Response() : pimpl(std::make_unique<Impl>()) {}
+Response::Response() : Response(std::pmr::get_default_resource()) {}
+
+Response::Response(std::pmr::memory_resource* memory)
+    : pimpl(new (memory->allocate(sizeof(Impl), alignof(Impl))) Impl(memory))
+{
+}
+
+void Response::ImplDeleter::operator()(Impl* impl) const
+{
+    std::pmr::memory_resource* memory = impl->memory;
+    impl->~Impl();
+    memory->deallocate(impl, sizeof(Impl), alignof(Impl));
+}
 
 Response::~Response() {}
 
@@ -139,11 +659,21 @@ Response& Response::send(const std::string& body)
     return *this;
 }
 
+Response& Response::sendShared(std::shared_ptr<const std::string> body)
+{
+    if (!pimpl->sentFlag)
+    {
+        pimpl->sharedBody = std::move(body);
+        pimpl->sentFlag = true;
+    }
+    return *this;
+}
+
 Response& Response::json(const std::any& jsonData)
 {
     if (!pimpl->sentFlag)
     {
-        pimpl->responseHeaders["Content-Type"] = "application/json";
+        pimpl->responseHeaders.set(KnownHeader::ContentType, "application/json");
 
         try
         {
@@ -181,7 +711,7 @@ Response& Response::jsonObject(const nlohmann::json& jsonObj)
 {
     if (!pimpl->sentFlag)
     {
-        pimpl->responseHeaders["Content-Type"] = "application/json";
+        pimpl->responseHeaders.set(KnownHeader::ContentType, "application/json");
         pimpl->responseBody = jsonObj.dump();
         pimpl->sentFlag = true;
     }
@@ -192,7 +722,7 @@ Response& Response::json(std::initializer_list<std::pair<std::string, nlohmann::
 {
     if (!pimpl->sentFlag)
     {
-        pimpl->responseHeaders["Content-Type"] = "application/json";
+        pimpl->responseHeaders.set(KnownHeader::ContentType, "application/json");
 
         nlohmann::json jsonObj;
         for (const auto& item : items)
@@ -210,7 +740,7 @@ Response& Response::jsonArray(std::initializer_list<nlohmann::json> items)
 {
     if (!pimpl->sentFlag)
     {
-        pimpl->responseHeaders["Content-Type"] = "application/json";
+        pimpl->responseHeaders.set(KnownHeader::ContentType, "application/json");
 
         nlohmann::json jsonArr = nlohmann::json::array();
         for (const auto& item : items)
@@ -232,7 +762,13 @@ Response& Response::status(int code)
 
 Response& Response::header(const std::string& name, const std::string& value)
 {
-    pimpl->responseHeaders[name] = value;
+    pimpl->responseHeaders.set(name, value);
+    return *this;
+}
+
+Response& Response::header(KnownHeader header, std::string_view value)
+{
+    pimpl->responseHeaders.set(header, value);
     return *this;
 }
 
@@ -240,7 +776,7 @@ Response& Response::headers(const std::map<std::string, std::string>& headers)
 {
     for (const auto& header : headers)
     {
-        pimpl->responseHeaders[header.first] = header.second;
+        pimpl->responseHeaders.set(header.first, header.second);
     }
     return *this;
 }
@@ -351,6 +887,11 @@ bool Response::sent() const
     return pimpl->sentFlag;
 }
 
+void Response::reset()
+{
+    pimpl->reset();
+}
+
 std::string Response::getRawResponse() const
 {
     return pimpl->buildResponseString();
@@ -363,12 +904,71 @@ int Response::getStatusCode() const
 
 std::map<std::string, std::string> Response::getHeaders() const
 {
-    return pimpl->responseHeaders;
+    std::map<std::string, std::string> headers;
+    for (const auto& header : pimpl->responseHeaders)
+    {
+        headers.emplace(std::string(header.name), std::string(header.value));
+    }
+    return headers;
+}
+
+std::string Response::getHeader(const std::string& name) const
+{
+    const std::pmr::string* value = pimpl->responseHeaders.find(name);
+    return value ? std::string(*value) : std::string();
+}
+
+bool Response::hasHeader(KnownHeader header) const
+{
+    return pimpl->responseHeaders.contains(header);
 }
 
 std::string Response::getBody() const
 {
-    return pimpl->responseBody;
+    return pimpl->fileBody.fd >= 0 ? pimpl->readFileBody() : std::string(pimpl->body());
+}
+
+std::string Response::getRawHeaders() const
+{
+    std::string head;
+    pimpl->writeHead(head, false, nullptr);
+    return head;
+}
+
+void Response::writeHead(std::string& out, const HeaderBlock* defaults) const
+{
+    pimpl->writeHead(out, false, defaults);
+}
+
+void Response::writeStreamHead(std::string& out, const HeaderBlock* defaults) const
+{
+    pimpl->writeHead(out, true, defaults);
+}
+
+std::string_view Response::getBodyView() const
+{
+    return pimpl->fileBody.fd >= 0 ? std::string_view() : pimpl->body();
+}
+
+void Response::serialize(std::vector<std::string_view>& segments) const
+{
+    pimpl->serializedHead.clear();
+    pimpl->writeHead(pimpl->serializedHead, false, nullptr);
+    segments.emplace_back(pimpl->serializedHead);
+    if (pimpl->fileBody.fd < 0 && !pimpl->body().empty())
+    {
+        segments.emplace_back(pimpl->body());
+    }
+}
+
+bool Response::hasFileBody() const
+{
+    return pimpl->fileBody.fd >= 0;
+}
+
+FileBody Response::getFileBody() const
+{
+    return pimpl->fileBody;
 }
 
 std::string Response::detectMimeType(const std::string& path) const
@@ -473,18 +1073,20 @@ Response& Response::sendFile(const std::string& path, const std::map<std::string
     try {
         std::filesystem::path filePath(path);
         
-        if (!std::filesystem::exists(filePath)) {
+        // Cached until the file changes, so a repeated send does not stat the file
+        std::shared_ptr<const FileMetadata> metadata = FileMetadataCache::instance().lookup(path);
+        if (!metadata) {
             status(404);
             return send("File not found");
         }
         
-        if (!std::filesystem::is_regular_file(filePath)) {
+        if (!metadata->regular) {
             status(403);
             return send("Not a file");
         }
         
         std::string contentType = detectMimeType(path);
-        if (pimpl->responseHeaders.find("Content-Type") == pimpl->responseHeaders.end()) {
+        if (!pimpl->responseHeaders.contains(KnownHeader::ContentType)) {
             header("Content-Type", contentType);
         }
         
@@ -495,39 +1097,28 @@ Response& Response::sendFile(const std::string& path, const std::map<std::string
         if (options.find("etag") != options.end() && options.at("etag").type() == typeid(std::string)) {
             header("ETag", std::any_cast<std::string>(options.at("etag")));
         } else {
-            std::string etag = "\"" + 
-                std::to_string(static_cast<long long>(std::filesystem::last_write_time(filePath).time_since_epoch().count())) + 
-                "-" + 
-                std::to_string(static_cast<uintmax_t>(std::filesystem::file_size(filePath))) + 
-                "\"";
-            header("ETag", etag);
-        }
-        
-        auto lastModified = std::filesystem::last_write_time(filePath);
-        auto fsEpochDuration = lastModified.time_since_epoch();
-        auto sysTime = std::chrono::system_clock::time_point(
-            std::chrono::duration_cast<std::chrono::system_clock::duration>(fsEpochDuration)
-        );
-        auto lastModifiedTime = std::chrono::system_clock::to_time_t(sysTime);
-        
-        char lastModifiedStr[100];
-        std::strftime(lastModifiedStr, sizeof(lastModifiedStr), 
-                     "%a, %d %b %Y %H:%M:%S GMT", 
-                     std::gmtime(&lastModifiedTime));
-        header("Last-Modified", lastModifiedStr);
+            header(KnownHeader::ETag, metadata->etag);
+        }
+        
+        header(KnownHeader::LastModified, metadata->lastModified);
         
         bool useStreaming = false;
         if (options.find("stream") != options.end() && options.at("stream").type() == typeid(bool)) {
             useStreaming = std::any_cast<bool>(options.at("stream"));
         } else {
-            auto fileSize = std::filesystem::file_size(filePath);
-            useStreaming = (fileSize > 1024 * 1024);
+            useStreaming = (metadata->size > 1024 * 1024);
         }
         
         if (useStreaming && pimpl->streamCallback) {
             return streamFile(path, options);
         }
         
+        // The server sends the file with sendfile(2); bytes never pass through user space
+        if (pimpl->openFileBody(filePath, false)) {
+            pimpl->sentFlag = true;
+            return *this;
+        }
+        
         std::ifstream file(filePath, std::ios::binary);
         if (!file) {
             status(500);
@@ -594,24 +1185,31 @@ Response& Response::streamFile(const std::string& path,
     try {
         std::filesystem::path filePath(path);
         
-        if (!std::filesystem::exists(filePath)) {
+        // Cached until the file changes, so a repeated send does not stat the file
+        std::shared_ptr<const FileMetadata> metadata = FileMetadataCache::instance().lookup(path);
+        if (!metadata) {
             status(404);
             return send("File not found");
         }
         
-        if (!std::filesystem::is_regular_file(filePath)) {
+        if (!metadata->regular) {
             status(403);
             return send("Not a file");
         }
         
         std::string contentType = detectMimeType(path);
-        if (pimpl->responseHeaders.find("Content-Type") == pimpl->responseHeaders.end()) {
+        if (!pimpl->responseHeaders.contains(KnownHeader::ContentType)) {
             header("Content-Type", contentType);
         }
         
         header("Transfer-Encoding", "chunked");
         
-        pimpl->responseHeaders.erase("Content-Length");
+        pimpl->responseHeaders.erase(knownHeaderName(KnownHeader::ContentLength));
+        
+        if (pimpl->openFileBody(filePath, true)) {
+            pimpl->sentFlag = true;
+            return *this;
+        }
         
         std::ifstream file(filePath, std::ios::binary);
         if (!file) {
@@ -633,14 +1231,7 @@ Response& Response::streamFile(const std::string& path,
             std::streamsize bytesRead = file.gcount();
             
             if (bytesRead > 0) {
-                std::stringstream chunkHeader;
-                chunkHeader << std::hex << bytesRead << "\r\n";
-                
-                pimpl->streamCallback(chunkHeader.str());
-                
-                pimpl->streamCallback(std::string(buffer, bytesRead));
-                
-                pimpl->streamCallback("\r\n");
+                pimpl->sendChunk(std::string_view(buffer, static_cast<size_t>(bytesRead)), false);
             }
             
             if (bytesRead < static_cast<std::streamsize>(chunkSize)) {
@@ -650,7 +1241,7 @@ Response& Response::streamFile(const std::string& path,
         
         delete[] buffer;
         
-        pimpl->streamCallback("0\r\n\r\n");
+        pimpl->sendChunk(std::string_view(), true);
         
     } catch (const std::exception& e) {
         status(500);
@@ -669,12 +1260,7 @@ Response& Response::stream(bool enable)
 Response& Response::write(const std::string& chunk)
 {
     if (pimpl->streamingEnabled && pimpl->streamCallback && !chunk.empty()) {
-        std::stringstream chunkHeader;
-        chunkHeader << std::hex << chunk.length() << "\r\n";
-        
-        pimpl->streamCallback(chunkHeader.str());
-        pimpl->streamCallback(chunk);
-        pimpl->streamCallback("\r\n");
+        pimpl->sendChunk(chunk, false);
     }
     return *this;
 }
@@ -682,7 +1268,7 @@ Response& Response::write(const std::string& chunk)
 Response& Response::end()
 {
     if (pimpl->streamingEnabled && pimpl->streamCallback) {
-        pimpl->streamCallback("0\r\n\r\n");
+        pimpl->sendChunk(std::string_view(), true);
         pimpl->sentFlag = true;
     }
     return *this;
@@ -690,22 +1276,31 @@ Response& Response::end()
 
 Response& Response::compress(bool enable)
 {
-    pimpl->compressionEnabled = enable;
-    if (enable) {
-        header("Content-Encoding", "gzip");
-    } else {
-        auto it = pimpl->responseHeaders.find("Content-Encoding");
-        if (it != pimpl->responseHeaders.end()) {
-            pimpl->responseHeaders.erase(it);
-        }
-    }
+    pimpl->compressionChoice = enable ? Impl::CompressionChoice::On : Impl::CompressionChoice::Off;
     return *this;
 }
 
+void Response::setCompressionContext(std::string_view acceptEncoding,
+                                     const CompressionOptions* automatic)
+{
+    pimpl->acceptEncoding = acceptEncoding;
+    pimpl->automaticCompression = automatic;
+}
+
+void Response::applyCompression()
+{
+    pimpl->compressBody();
+}
+
 Response& Response::setStreamCallback(std::function<void(const std::string&)> callback)
 {
     pimpl->streamCallback = callback;
     return *this;
 }
 
+bool Response::streamEnded() const
+{
+    return pimpl->streamEnded;
+}
+
 } // namespace boson
\ No newline at end of file
@@ -7,12 +7,75 @@
 #include <algorithm>
 #include <map>
 #include <regex>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace boson
 {
 
+namespace
+{
+
+bool isParamChar(char c)
+{
+    return RoutePattern::isParamChar(c);
+}
+
+bool startsParam(const std::string& pattern, size_t position)
+{
+    return pattern[position] == ':' && position + 1 < pattern.size() &&
+           isParamChar(pattern[position + 1]);
+}
+
+bool isTrailingWildcard(const std::string& pattern, size_t position)
+{
+    return pattern[position] == '*' && position + 1 == pattern.size();
+}
+
+/**
+ * @brief Check and classify a route path, naming it in any error
+ */
+RoutePattern parsePattern(const std::string& pattern)
+{
+    try
+    {
+        return RoutePattern(pattern);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        throw std::invalid_argument(std::string(e.what()) + ": " + pattern);
+    }
+}
+
+/**
+ * @brief Strip trailing slashes from a mount path so it can be joined with route paths
+ */
+std::string normalizeMountPath(const std::string& path)
+{
+    size_t end = path.size();
+    while (end > 0 && path[end - 1] == '/')
+    {
+        end--;
+    }
+    std::string base = path.substr(0, end);
+    if (!base.empty() && base[0] != '/')
+    {
+        base.insert(0, "/");
+    }
+    return base;
+}
+
+void throwIfFrozen(bool frozen)
+{
+    if (frozen)
+    {
+        throw std::logic_error("Routes cannot be added to a frozen router");
+    }
+}
+
+} // namespace
+
 RouterPtr Router::create()
 {
     return std::make_shared<Router>();
@@ -24,7 +87,7 @@ Router::~Router() {}
 
 Router& Router::get(const std::string& path, const RouteHandler& handler)
 {
-    return addRoute("GET", path, handler);
+    return addRoute(HttpMethod::GET, path, handler);
 }
 
 // Overload for middleware support
@@ -32,19 +95,19 @@ Router& Router::get(const std::string& path, const Middleware& middleware,
                     const RouteHandler& handler)
 {
     std::vector<Middleware> middlewares = {middleware};
-    return addRouteWithMiddleware("GET", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::GET, path, handler, middlewares);
 }
 
 // Overload for multiple middleware
 Router& Router::get(const std::string& path, const std::vector<Middleware>& middlewares,
                     const RouteHandler& handler)
 {
-    return addRouteWithMiddleware("GET", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::GET, path, handler, middlewares);
 }
 
 Router& Router::post(const std::string& path, const RouteHandler& handler)
 {
-    return addRoute("POST", path, handler);
+    return addRoute(HttpMethod::POST, path, handler);
 }
 
 // Overload for middleware support
@@ -52,266 +115,520 @@ Router& Router::post(const std::string& path, const Middleware& middleware,
                      const RouteHandler& handler)
 {
     std::vector<Middleware> middlewares = {middleware};
-    return addRouteWithMiddleware("POST", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::POST, path, handler, middlewares);
 }
 
 // Overload for multiple middleware
 Router& Router::post(const std::string& path, const std::vector<Middleware>& middlewares,
                      const RouteHandler& handler)
 {
-    return addRouteWithMiddleware("POST", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::POST, path, handler, middlewares);
 }
 
 Router& Router::put(const std::string& path, const RouteHandler& handler)
 {
-    return addRoute("PUT", path, handler);
+    return addRoute(HttpMethod::PUT, path, handler);
 }
 
 Router& Router::put(const std::string& path, const Middleware& middleware,
                     const RouteHandler& handler)
 {
     std::vector<Middleware> middlewares = {middleware};
-    return addRouteWithMiddleware("PUT", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::PUT, path, handler, middlewares);
 }
 
 Router& Router::put(const std::string& path, const std::vector<Middleware>& middlewares,
                     const RouteHandler& handler)
 {
-    return addRouteWithMiddleware("PUT", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::PUT, path, handler, middlewares);
 }
 
 Router& Router::del(const std::string& path, const RouteHandler& handler)
 {
-    return addRoute("DELETE", path, handler);
+    return addRoute(HttpMethod::DELETE, path, handler);
 }
 
 Router& Router::del(const std::string& path, const Middleware& middleware,
                     const RouteHandler& handler)
 {
     std::vector<Middleware> middlewares = {middleware};
-    return addRouteWithMiddleware("DELETE", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::DELETE, path, handler, middlewares);
 }
 
 Router& Router::del(const std::string& path, const std::vector<Middleware>& middlewares,
                     const RouteHandler& handler)
 {
-    return addRouteWithMiddleware("DELETE", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::DELETE, path, handler, middlewares);
 }
 
 Router& Router::patch(const std::string& path, const RouteHandler& handler)
 {
-    return addRoute("PATCH", path, handler);
+    return addRoute(HttpMethod::PATCH, path, handler);
 }
 
 Router& Router::patch(const std::string& path, const Middleware& middleware,
                       const RouteHandler& handler)
 {
     std::vector<Middleware> middlewares = {middleware};
-    return addRouteWithMiddleware("PATCH", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::PATCH, path, handler, middlewares);
 }
 
 Router& Router::patch(const std::string& path, const std::vector<Middleware>& middlewares,
                       const RouteHandler& handler)
 {
-    return addRouteWithMiddleware("PATCH", path, handler, middlewares);
+    return addRouteWithMiddleware(HttpMethod::PATCH, path, handler, middlewares);
 }
 
 Router& Router::use(const Middleware& middleware)
 {
+    throwIfFrozen(frozen);
     routerMiddleware.push_back(middleware);
     return *this;
 }
 
 Router& Router::use(const std::string& path, const Router& router)
 {
-    subRouters.push_back(std::make_pair(path, router));
-    return *this;
-}
+    throwIfFrozen(frozen);
+    std::string base = normalizeMountPath(path);
 
-bool Router::handle(const Request& req, Response& res) const
-{
-    // First try to match against sub-routers
-    for (const auto& pair : subRouters)
+    for (const Route& source : router.routes)
     {
-        const std::string& basePath = pair.first;
-        const Router& router = pair.second;
+        Route route = source;
+        if (!source.mounted && !router.frozen)
+        {
+            // The sub-router's own middleware runs only for its own routes, before theirs
+            route.middleware = router.routerMiddleware;
+            route.middleware.insert(route.middleware.end(), source.middleware.begin(),
+                                    source.middleware.end());
+        }
+        route.mounted = true;
+        route.mountLength = base.size() + source.mountLength;
 
-        // Check if the request path starts with the sub-router base path
-        if (req.path().compare(0, basePath.length(), basePath) == 0)
+        if (source.path.empty() || source.path == "/")
         {
-            // Adjust the path for the sub-router
-            std::string adjustedPath = req.path().substr(basePath.length());
-            if (adjustedPath.empty() || adjustedPath[0] != '/')
+            // The sub-router's root answers both "/base" and "/base/"
+            route.path = base.empty() ? "/" : base;
+            if (!base.empty())
             {
-                adjustedPath = "/" + adjustedPath;
+                Route withSlash = route;
+                withSlash.path += '/';
+                bool usesRegex = parsePattern(withSlash.path).usesRegex();
+                insertRoute(std::move(withSlash), usesRegex);
             }
+        }
+        else
+        {
+            route.path = base + (source.path[0] == '/' ? "" : "/") + source.path;
+        }
+        // The joined path is a new pattern, so it is checked again
+        bool usesRegex = parsePattern(route.path).usesRegex();
+        insertRoute(std::move(route), usesRegex);
+    }
+    return *this;
+}
 
-            // Create a modified copy of the request path
-            std::string originalPath = req.path();
+void Router::freeze()
+{
+    if (frozen)
+    {
+        return;
+    }
+    for (Route& route : routes)
+    {
+        if (!route.mounted && !routerMiddleware.empty())
+        {
+            route.middleware.insert(route.middleware.begin(), routerMiddleware.begin(),
+                                    routerMiddleware.end());
+        }
+    }
+    routerMiddleware.clear();
+    frozen = true;
+}
 
-            // Temporarily change the request path (use const_cast since we'll restore it)
-            Request& mutableReq = const_cast<Request&>(req);
-            mutableReq.setOriginalPath(originalPath); // Store original path
-            mutableReq.overridePath(adjustedPath);    // Override with adjusted path
+bool Router::handle(Request& req, Response& res) const
+{
+    // Routes are matched against the full path, whatever an earlier dispatch recorded
+    req.setMountPrefix(0);
 
-            // Try to handle the request with the sub-router
-            bool handled = router.handle(req, res);
+    // Mounted routers were merged at use(), so one lookup in this method's table suffices
+    RouteMatch match;
+    const Route* route = matchRoute(req.methodType(), req.pathView(), match);
 
-            // Restore original path
-            mutableReq.overridePath(originalPath);
+    if (!route)
+    {
+        // No matching route found
+        return false;
+    }
 
-            if (handled)
-            {
-                return true;
-            }
+    // Set route parameters on the request
+    for (size_t i = 0; i < match.count; i++)
+    {
+        req.addRouteParam(route->paramNames[i], match.values[i]);
+    }
+
+    // Handlers of a mounted router see the path below its mount point
+    req.setMountPrefix(route->mountLength);
+
+    // Router middleware is folded into each route by freeze(); until then it is added here
+    MiddlewareSelection middleware;
+    if (!route->mounted)
+    {
+        for (const auto& layer : routerMiddleware)
+        {
+            middleware.add(layer);
         }
     }
+    for (const auto& layer : route->middleware)
+    {
+        middleware.add(layer);
+    }
 
-    // If no sub-router matches, try to match routes directly
-    for (const auto& route : routes)
+    // The handler runs only if every middleware passed the request on without responding
+    if (middleware.run(req, res))
     {
-        std::map<std::string, std::string> params;
-        if (route.method == req.method() && matchPath(route.path, req.path(), params))
+        if (route->direct.invoke)
         {
-            // Set route parameters on the request
-            Request& mutableReq = const_cast<Request&>(req);
-            for (const auto& param : params)
-            {
-                mutableReq.setRouteParam(param.first, param.second);
-            }
+            route->direct.invoke(route->direct.target.get(), req, res);
+        }
+        else
+        {
+            route->handler(req, res);
+        }
+    }
 
-            bool continueProcessing = true;
-            
-            std::vector<Middleware> middlewareChain;
-            
-
-            std::copy(routerMiddleware.begin(), routerMiddleware.end(), 
-                     std::back_inserter(middlewareChain));
-            
-            std::copy(route.middleware.begin(), route.middleware.end(), 
-                     std::back_inserter(middlewareChain));
-                     
-            if (!middlewareChain.empty()) {
-                size_t currentIndex = 0;
-                
-                std::function<void(const Request&, Response&)> executeNext;
-                executeNext = [&](const Request& request, Response& response) {
-                    if (currentIndex >= middlewareChain.size() || response.sent()) {
-                        continueProcessing = true;
-                        return;
-                    }
-                    
-                    NextFunction next;
-                    next.setNext([&](const Request& r, Response& s, NextFunction& n) {
-                        currentIndex++;
-                        executeNext(request, response);
-                    });
-                    next.setRequestResponse(request, response);
-                    
-                    continueProcessing = false;
-                    middlewareChain[currentIndex](request, response, next);
-                };
-                
-                executeNext(req, res);
-                
-                if (res.sent()) {
-                    return true;
-                }
-            }
+    return true;
+}
 
-            if (continueProcessing && !res.sent()) {
-                route.handler(req, res);
+std::string Router::allowedMethods(std::string_view path) const
+{
+    std::string allow;
+    RouteMatch match;
+    for (size_t method = 0; method < kHttpMethodCount; method++)
+    {
+        match.count = 0;
+        if (matchRoute(static_cast<HttpMethod>(method), path, match))
+        {
+            if (!allow.empty())
+            {
+                allow += ", ";
             }
-            
-            return true;
+            allow += httpMethodName(static_cast<HttpMethod>(method));
         }
     }
-
-    // No matching route found
-    return false;
+    return allow;
 }
 
-Router& Router::addRoute(const std::string& method, const std::string& path,
-                         const RouteHandler& handler)
+Router& Router::route(HttpMethod method, const RoutePattern& path, const RouteHandler& handler,
+                      const std::vector<Middleware>& middlewares)
 {
+    throwIfFrozen(frozen);
+
     Route route;
     route.method = method;
-    route.path = path;
+    route.path = std::string(path.path());
     route.handler = handler;
+    route.middleware = middlewares;
+
+    insertRoute(std::move(route), path.usesRegex());
+    return *this;
+}
+
+Router& Router::route(HttpMethod method, const RoutePattern& path, DirectHandler handler,
+                      const std::vector<Middleware>& middlewares)
+{
+    throwIfFrozen(frozen);
+
+    Route route;
+    route.method = method;
+    route.path = std::string(path.path());
+    route.direct = std::move(handler);
+    route.middleware = middlewares;
 
-    routes.push_back(route);
+    insertRoute(std::move(route), path.usesRegex());
     return *this;
 }
 
+Router& Router::addRoute(HttpMethod method, const std::string& path,
+                         const RouteHandler& handler)
+{
+    return addRouteWithMiddleware(method, path, handler, {});
+}
+
 // Add support for route-specific middleware
-Router& Router::addRouteWithMiddleware(const std::string& method, const std::string& path,
+Router& Router::addRouteWithMiddleware(HttpMethod method, const std::string& path,
                                        const RouteHandler& handler,
                                        const std::vector<Middleware>& middleware)
 {
+    throwIfFrozen(frozen);
+
     Route route;
     route.method = method;
     route.path = path;
     route.handler = handler;
     route.middleware = middleware;
 
-    routes.push_back(route);
+    insertRoute(std::move(route), parsePattern(path).usesRegex());
     return *this;
 }
 
-bool Router::matchPath(const std::string& pattern, const std::string& path,
-                       std::map<std::string, std::string>& params) const
+void Router::insertRoute(Route route, bool usesRegex)
 {
-    if (pattern == path)
+    route.paramNames.clear();
+    route.paramGroups.clear();
+    route.pattern.reset();
+    routes.push_back(std::move(route));
+    compileRoute(routes.size() - 1, usesRegex);
+}
+
+void Router::compileRoute(size_t routeIndex, bool usesRegex)
+{
+    Route& route = routes[routeIndex];
+    RouteTable& table = tables[static_cast<size_t>(route.method)];
+    const std::string& pattern = route.path;
+
+    if (usesRegex)
     {
-        return true;
+        // Replace each :param with a capture group and remember which group it became, since
+        // the pattern's own groups are numbered alongside them
+        std::string expression = "^";
+        size_t groups = 0;
+        for (size_t i = 0; i < pattern.size();)
+        {
+            if (startsParam(pattern, i))
+            {
+                size_t end = i + 1;
+                while (end < pattern.size() && isParamChar(pattern[end]))
+                {
+                    end++;
+                }
+                route.paramNames.push_back(pattern.substr(i + 1, end - i - 1));
+                route.paramGroups.push_back(++groups);
+                expression += "([^/]+)";
+                i = end;
+                continue;
+            }
+            if (pattern[i] == '\\' && i + 1 < pattern.size())
+            {
+                expression.append(pattern, i, 2);
+                i += 2;
+                continue;
+            }
+            if (pattern[i] == '(' && (i + 1 == pattern.size() || pattern[i + 1] != '?'))
+            {
+                groups++;
+            }
+            expression += pattern[i++];
+        }
+        route.pattern = std::make_shared<const std::regex>(expression + "$");
+        table.regexRoutes.push_back(routeIndex);
+        return;
     }
 
-    if (pattern.empty())
+    size_t node = 0;
+    size_t position = 0;
+    while (position < pattern.size())
     {
-        return false;
-    }
+        if (startsParam(pattern, position))
+        {
+            size_t end = position + 1;
+            while (end < pattern.size() && isParamChar(pattern[end]))
+            {
+                end++;
+            }
+            route.paramNames.push_back(pattern.substr(position + 1, end - position - 1));
+
+            if (table.nodes[node].paramChild < 0)
+            {
+                table.nodes.emplace_back();
+                table.nodes[node].paramChild = static_cast<long>(table.nodes.size() - 1);
+            }
+            node = static_cast<size_t>(table.nodes[node].paramChild);
+            position = end;
+
+            // Text right after a param in the same segment ("/:name.json") makes lookup
+            // try shorter param values as well
+            if (position < pattern.size() && pattern[position] != '/' &&
+                !isTrailingWildcard(pattern, position))
+            {
+                table.nodes[node].paramHasSuffix = true;
+            }
+            continue;
+        }
+
+        if (isTrailingWildcard(pattern, position))
+        {
+            route.paramNames.push_back("*");
+            break;
+        }
 
-    std::regex paramNameRegex(":([a-zA-Z0-9_]+)");
-    std::smatch paramNameMatch;
-    std::string patternCopy = pattern;
-    std::vector<std::string> paramNames;
+        size_t end = position;
+        while (end < pattern.size() && !startsParam(pattern, end) &&
+               !isTrailingWildcard(pattern, end))
+        {
+            end++;
+        }
+        node = insertStatic(table, node,
+                            std::string_view(pattern).substr(position, end - position));
+        position = end;
+    }
 
-    while (std::regex_search(patternCopy, paramNameMatch, paramNameRegex))
+    // The first route registered for a pattern wins, as it did when routes were scanned in order
+    long& slot = position == pattern.size() ? table.nodes[node].route
+                                            : table.nodes[node].wildcardRoute;
+    if (slot < 0)
     {
-        paramNames.push_back(paramNameMatch[1].str());
-        patternCopy = paramNameMatch.suffix();
+        slot = static_cast<long>(routeIndex);
     }
+}
 
-    std::string regexPattern = pattern;
-    std::regex paramRegex(":[a-zA-Z0-9_]+");
-    std::string regexReplacement = "([^/]+)";
-    regexPattern = std::regex_replace(regexPattern, paramRegex, regexReplacement);
+size_t Router::insertStatic(RouteTable& table, size_t node, std::string_view label)
+{
+    std::vector<RouteNode>& nodes = table.nodes;
+    while (!label.empty())
+    {
+        size_t child = 0;
+        bool found = false;
+        for (size_t candidate : nodes[node].children)
+        {
+            if (nodes[candidate].prefix[0] == label[0])
+            {
+                child = candidate;
+                found = true;
+                break;
+            }
+        }
 
-    regexPattern = "^" + regexPattern + "$";
+        if (!found)
+        {
+            RouteNode leaf;
+            leaf.prefix = std::string(label);
+            nodes.push_back(std::move(leaf));
+            nodes[node].children.push_back(nodes.size() - 1);
+            return nodes.size() - 1;
+        }
 
-    std::regex re(regexPattern);
-    std::smatch match;
+        size_t common = 0;
+        const std::string& prefix = nodes[child].prefix;
+        while (common < prefix.size() && common < label.size() && prefix[common] == label[common])
+        {
+            common++;
+        }
 
-    if (std::regex_match(path, match, re))
-    {
+        if (common < prefix.size())
+        {
+            // Split the edge: the existing node keeps the shared part, a new node the rest
+            RouteNode tail = std::move(nodes[child]);
+            nodes[child] = RouteNode();
+            nodes[child].prefix = tail.prefix.substr(0, common);
+            tail.prefix.erase(0, common);
+            nodes.push_back(std::move(tail));
+            nodes[child].children.push_back(nodes.size() - 1);
+        }
+
+        node = child;
+        label.remove_prefix(common);
+    }
+    return node;
+}
 
-        for (size_t i = 0; i < paramNames.size(); i++)
+const Router::Route* Router::matchRoute(HttpMethod method, std::string_view path,
+                                        RouteMatch& match) const
+{
+    const RouteTable& table = tables[static_cast<size_t>(method)];
+    const Route* route = findRoute(table, 0, path, 0, match);
+
+    // Regex routes come after static and :param matches but before a catch-all '*'
+    bool wildcardOnly = route && !route->paramNames.empty() && route->paramNames.back() == "*";
+    if (!table.regexRoutes.empty() && (!route || wildcardOnly))
+    {
+        std::cmatch regexMatch;
+        for (size_t index : table.regexRoutes)
         {
-            if (i + 1 < match.size())
+            const Route& candidate = routes[index];
+            if (std::regex_match(path.data(), path.data() + path.size(), regexMatch,
+                                 *candidate.pattern))
             {
-                params[paramNames[i]] = match[i + 1].str();
+                match.count = 0;
+                for (size_t group : candidate.paramGroups)
+                {
+                    match.values[match.count++] =
+                        std::string_view(regexMatch[group].first, regexMatch[group].length());
+                }
+                return &candidate;
             }
         }
-        return true;
     }
-
-    return false;
+    return route;
 }
 
-bool Router::matchPath(const std::string& pattern, const std::string& path) const
+const Router::Route* Router::findRoute(const RouteTable& table, size_t node,
+                                       std::string_view path, size_t position,
+                                       RouteMatch& match) const
 {
-    std::map<std::string, std::string> params;
-    return matchPath(pattern, path, params);
+    const std::vector<RouteNode>& nodes = table.nodes;
+    const RouteNode& current = nodes[node];
+
+    if (position == path.size())
+    {
+        if (current.route >= 0)
+        {
+            return &routes[static_cast<size_t>(current.route)];
+        }
+    }
+    else
+    {
+        // Static children first; at most one can start with the next character
+        for (size_t child : current.children)
+        {
+            const std::string& prefix = nodes[child].prefix;
+            if (prefix[0] != path[position])
+            {
+                continue;
+            }
+            if (path.substr(position, prefix.size()) == prefix)
+            {
+                if (const Route* route =
+                        findRoute(table, child, path, position + prefix.size(), match))
+                {
+                    return route;
+                }
+            }
+            break;
+        }
+
+        // Then a :param, which takes at least one character and never crosses a '/'
+        if (current.paramChild >= 0 && path[position] != '/' && match.count < kMaxRouteParams)
+        {
+            size_t paramNode = static_cast<size_t>(current.paramChild);
+            size_t segmentEnd = path.find('/', position);
+            if (segmentEnd == std::string_view::npos)
+            {
+                segmentEnd = path.size();
+            }
+
+            for (size_t end = segmentEnd; end > position; end--)
+            {
+                match.values[match.count++] = path.substr(position, end - position);
+                if (const Route* route = findRoute(table, paramNode, path, end, match))
+                {
+                    return route;
+                }
+                match.count--;
+                if (!nodes[paramNode].paramHasSuffix)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // A trailing '*' takes whatever is left, including nothing
+    if (current.wildcardRoute >= 0 && match.count < kMaxRouteParams)
+    {
+        match.values[match.count++] = path.substr(position);
+        return &routes[static_cast<size_t>(current.wildcardRoute)];
+    }
+    return nullptr;
 }
 
-} // namespace boson
\ No newline at end of file
+} // namespace boson
@@ -1,11 +1,15 @@
 #include "boson/server.hpp"
 #include "boson/error_handler.hpp"
+#include "boson/http_parser.hpp"
 #include "boson/middleware.hpp"
 #include "boson/request.hpp"
+#include "boson/request_pool.hpp"
 #include "boson/response.hpp"
 #include "boson/router.hpp"
 
 #include <atomic>
+#include <charconv>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
 #include <functional>
@@ -15,7 +19,9 @@
 #include <mutex>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 
@@ -28,22 +34,1507 @@ using socket_t = SOCKET;
 #define close_socket closesocket
 #else
 #include <arpa/inet.h>
+#include <cerrno>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 using socket_t = int;
 #define SOCKET_ERROR_VALUE (-1)
 #define close_socket close
 #endif
 
+#ifdef __linux__
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#define BOSON_HAS_EPOLL 1
+#define BOSON_HAS_SENDFILE 1
+#endif
+
+#if defined(BOSON_WITH_IO_URING) && defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT)
+#define BOSON_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define BOSON_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define BOSON_SEND_FLAGS 0
+#endif
+
 namespace boson
 {
 
+namespace
+{
+
+constexpr size_t kReadChunkSize = 16384;
+constexpr size_t kMaxHeaderSize = 65536;
+constexpr size_t kMaxBodySize = 16 * 1024 * 1024;
+constexpr int kSendTimeoutMs = 30000;
+constexpr size_t kMaxPendingOutput = 262144;
+// Bodies below this are copied into the pipelined output batch; larger ones are sent in place
+constexpr size_t kInlineBodyLimit = 16384;
+constexpr size_t kMaxSendSegments = 16;
+constexpr int kAcceptBatch = 64;
+
+/**
+ * @brief Result of scanning a connection buffer for a complete request
+ */
+enum class FrameStatus
+{
+    Incomplete,
+    Complete,
+    Invalid,         ///< Answered with 400 and the connection closed
+    Unsupported,     ///< Transfer-Encoding request, answered with 501 and the connection closed
+    HeadersTooLarge, ///< Answered with 431 and the connection closed
+    BodyTooLarge     ///< Answered with 413 and the connection closed
+};
+
+/**
+ * @brief Check whether framing refused the request, which frameRejection() then answers
+ */
+bool isRejected(FrameStatus status)
+{
+    return status != FrameStatus::Complete && status != FrameStatus::Incomplete;
+}
+
+/**
+ * @brief Largest request head and body a connection's parser accepts
+ */
+struct RequestLimits
+{
+    size_t maxHeaderSize = kMaxHeaderSize;
+    size_t maxBodySize = kMaxBodySize;
+};
+
+/**
+ * @brief Per-connection state shared between an event loop and the worker pool
+ */
+struct Connection
+{
+    explicit Connection(const RequestLimits& limits)
+        : parser(limits.maxHeaderSize, limits.maxBodySize)
+    {
+    }
+
+    socket_t fd = SOCKET_ERROR_VALUE;
+    std::string buffer;
+    std::string output;
+    std::vector<std::string_view> segments; ///< Write list, reused for every response
+    HttpParser parser;
+    size_t requestStart = 0;
+    size_t requestLength = 0;
+    size_t requestCount = 0;
+    bool busy = false;
+    std::chrono::steady_clock::time_point lastActive = std::chrono::steady_clock::now();
+    void* loop = nullptr;
+    bool uring = false; ///< loop is a UringLoop rather than an EventLoop
+
+    /**
+     * @brief Step past the request that was just handled
+     *
+     * Pipelined requests are consumed by moving requestStart forward; the buffer itself is
+     * only compacted once the whole batch has been handled.
+     */
+    void consumeRequest()
+    {
+        requestStart += requestLength;
+        requestLength = 0;
+        parser.reset();
+    }
+
+    /**
+     * @brief Discard consumed requests, keeping any partial request that followed them
+     */
+    void compact()
+    {
+        if (requestStart > 0)
+        {
+            buffer.erase(0, requestStart);
+            requestStart = 0;
+        }
+    }
+};
+
+/**
+ * @brief Find the extent of the next request in a connection buffer
+ *
+ * Framing starts at requestStart, so several pipelined requests can be split out of one
+ * buffer in turn. The connection's parser resumes where it stopped, so bytes arriving in
+ * small reads are only scanned once; its token positions are reused to build the Request.
+ */
+FrameStatus frameRequest(Connection& conn)
+{
+    switch (conn.parser.parse(conn.buffer.data() + conn.requestStart,
+                              conn.buffer.size() - conn.requestStart))
+    {
+    case HttpParser::Status::Complete:
+        conn.requestLength = conn.parser.messageLength();
+        return FrameStatus::Complete;
+    case HttpParser::Status::Invalid:
+        return FrameStatus::Invalid;
+    case HttpParser::Status::Unsupported:
+        return FrameStatus::Unsupported;
+    case HttpParser::Status::HeadersTooLarge:
+        return FrameStatus::HeadersTooLarge;
+    case HttpParser::Status::BodyTooLarge:
+        return FrameStatus::BodyTooLarge;
+    case HttpParser::Status::Incomplete:
+        break;
+    }
+    return FrameStatus::Incomplete;
+}
+
+/**
+ * @brief Get the response to a request that could not be framed
+ *
+ * Nothing after such a request can be trusted to start where the client meant it to, so the
+ * response closes the connection.
+ */
+std::string_view frameRejection(FrameStatus status)
+{
+    switch (status)
+    {
+    case FrameStatus::Unsupported:
+        return "HTTP/1.1 501 Not Implemented\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    case FrameStatus::HeadersTooLarge:
+        return "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\n"
+               "Content-Length: 0\r\n\r\n";
+    case FrameStatus::BodyTooLarge:
+        return "HTTP/1.1 413 Content Too Large\r\nConnection: close\r\n"
+               "Content-Length: 0\r\n\r\n";
+    default:
+        return "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    }
+}
+
+/**
+ * @brief Write a whole buffer to a (possibly non-blocking) socket
+ * @return False if the peer went away or the write timed out
+ */
+bool sendAll(socket_t fd, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        auto sent = send(fd, data, static_cast<int>(length), BOSON_SEND_FLAGS);
+        if (sent > 0)
+        {
+            data += sent;
+            length -= static_cast<size_t>(sent);
+            continue;
+        }
+#ifndef _WIN32
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, kSendTimeoutMs) > 0)
+            {
+                continue;
+            }
+        }
+#endif
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Write buffers in order with scatter-gather sends, resuming after partial writes
+ * @param segments Buffers to send; consumed as they are written
+ */
+bool sendSegments(socket_t fd, std::vector<std::string_view>& segments)
+{
+#ifdef _WIN32
+    for (const auto& segment : segments)
+    {
+        if (!sendAll(fd, segment.data(), segment.size()))
+        {
+            return false;
+        }
+    }
+    return true;
+#else
+    size_t index = 0;
+    while (true)
+    {
+        while (index < segments.size() && segments[index].empty())
+        {
+            index++;
+        }
+        if (index == segments.size())
+        {
+            return true;
+        }
+
+        struct iovec iov[kMaxSendSegments];
+        size_t count = 0;
+        for (size_t i = index; i < segments.size() && count < kMaxSendSegments; i++)
+        {
+            if (!segments[i].empty())
+            {
+                iov[count].iov_base = const_cast<char*>(segments[i].data());
+                iov[count].iov_len = segments[i].size();
+                count++;
+            }
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        auto sent = sendmsg(fd, &msg, BOSON_SEND_FLAGS);
+        if (sent > 0)
+        {
+            auto remaining = static_cast<size_t>(sent);
+            while (remaining > 0)
+            {
+                size_t step = std::min(remaining, segments[index].size());
+                segments[index].remove_prefix(step);
+                remaining -= step;
+                if (segments[index].empty())
+                {
+                    index++;
+                }
+            }
+            continue;
+        }
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, kSendTimeoutMs) > 0)
+            {
+                continue;
+            }
+        }
+        return false;
+    }
+#endif
+}
+
+#ifdef BOSON_HAS_SENDFILE
+/**
+ * @brief Write a file region with sendfile(2), waiting for POLLOUT whenever the socket is full
+ */
+bool sendFileRegion(socket_t fd, int fileFd, uint64_t offset, uint64_t length)
+{
+    off_t position = static_cast<off_t>(offset);
+    while (length > 0)
+    {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(length, 1u << 30));
+        ssize_t sent = sendfile(fd, fileFd, &position, count);
+        if (sent > 0)
+        {
+            length -= static_cast<uint64_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, kSendTimeoutMs) > 0)
+            {
+                continue;
+            }
+        }
+        // Error, timeout, or the file shrank underneath the advertised length
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief Write responses queued on a connection, preserving their order
+ */
+bool flushOutput(Connection& conn)
+{
+    if (conn.output.empty())
+    {
+        return true;
+    }
+    bool ok = sendAll(conn.fd, conn.output.data(), conn.output.size());
+    conn.output.clear();
+    return ok;
+}
+
+bool setNonBlocking(socket_t fd)
+{
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+#ifdef BOSON_HAS_EPOLL
+
+/**
+ * @class EventLoop
+ * @brief Edge-triggered epoll loop that reads connections until a full request is buffered
+ *
+ * Connections are registered with EPOLLONESHOT: once a request is complete the loop hands the
+ * connection to the worker pool and does not touch it again until the worker re-arms it.
+ * In SO_REUSEPORT mode a loop also owns a listening socket and accepts its own connections.
+ */
+class EventLoop
+{
+  public:
+    using DispatchFn = std::function<void(Connection*)>;
+
+    EventLoop(const std::atomic<bool>& running, int idleTimeoutSeconds,
+              const RequestLimits& limits, DispatchFn dispatch)
+        : running(running), idleTimeout(idleTimeoutSeconds), limits(limits),
+          dispatch(std::move(dispatch)), epollFd(-1), wakeFd(-1), listenFd(-1)
+    {
+    }
+
+    ~EventLoop()
+    {
+        closeAll();
+        if (listenFd >= 0)
+        {
+            close(listenFd);
+        }
+        if (wakeFd >= 0)
+        {
+            close(wakeFd);
+        }
+        if (epollFd >= 0)
+        {
+            close(epollFd);
+        }
+    }
+
+    bool open()
+    {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0)
+        {
+            return false;
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) == 0;
+    }
+
+    /**
+     * @brief Give this loop its own listening socket
+     * @return False if it could not be registered, in which case the caller still owns it
+     */
+    bool addListener(socket_t fd)
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = this;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            return false;
+        }
+
+        listenFd = fd;
+        return true;
+    }
+
+    void start() { thread = std::thread(&EventLoop::run, this); }
+
+    void stop()
+    {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    void addConnection(socket_t fd)
+    {
+        auto conn = std::make_unique<Connection>(limits);
+        conn->fd = fd;
+        conn->loop = this;
+
+        Connection* raw = conn.get();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.emplace(raw, std::move(conn));
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+        ev.data.ptr = raw;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            closeConnection(raw);
+        }
+    }
+
+    /**
+     * @brief Return a connection from a worker to this loop and wait for its next request
+     */
+    void release(Connection* conn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        conn->busy = false;
+        conn->lastActive = std::chrono::steady_clock::now();
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &ev) < 0)
+        {
+            close_socket(conn->fd);
+            connections.erase(conn);
+        }
+    }
+
+    void rearm(Connection* conn)
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+        ev.data.ptr = conn;
+        if (epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &ev) < 0)
+        {
+            closeConnection(conn);
+        }
+    }
+
+    void closeConnection(Connection* conn)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        close_socket(conn->fd);
+        connections.erase(conn);
+    }
+
+    void closeAll()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : connections)
+        {
+            close_socket(entry.second->fd);
+        }
+        connections.clear();
+    }
+
+  private:
+    void run()
+    {
+        constexpr int maxEvents = 256;
+        struct epoll_event events[maxEvents];
+
+        while (running)
+        {
+            int count = epoll_wait(epollFd, events, maxEvents, 1000);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                if (events[i].data.ptr == nullptr)
+                {
+                    uint64_t value;
+                    ssize_t ignored = ::read(wakeFd, &value, sizeof(value));
+                    (void)ignored;
+                    continue;
+                }
+                if (events[i].data.ptr == this)
+                {
+                    acceptConnections();
+                    continue;
+                }
+
+                onReadable(static_cast<Connection*>(events[i].data.ptr), events[i].events);
+            }
+
+            // Only once the batch is handled: events[] may point at connections the sweep
+            // frees, and their descriptors could be reused by the time they are read
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastSweep >= std::chrono::seconds(1))
+            {
+                closeIdle(now);
+                lastSweep = now;
+            }
+        }
+    }
+
+    /**
+     * @brief Close connections that have not produced a request within the idle timeout
+     *
+     * Partially received requests count as idle too, which bounds how long a slow client can
+     * hold a connection open.
+     */
+    void closeIdle(std::chrono::steady_clock::time_point now)
+    {
+        if (idleTimeout <= 0)
+        {
+            return;
+        }
+
+        auto limit = std::chrono::seconds(idleTimeout);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = connections.begin(); it != connections.end();)
+        {
+            Connection* conn = it->first;
+            if (!conn->busy && now - conn->lastActive > limit)
+            {
+                close_socket(conn->fd);
+                it = connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief Accept a bounded batch of connections from this loop's listener
+     *
+     * The listener is level-triggered, so anything left in the backlog is picked up on the
+     * next wakeup without starving connections that are already being read.
+     */
+    void acceptConnections()
+    {
+        for (int i = 0; i < kAcceptBatch; i++)
+        {
+            socket_t fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    std::cerr << "Failed to accept connection" << std::endl;
+                }
+                return;
+            }
+            addConnection(fd);
+        }
+    }
+
+    void onReadable(Connection* conn, uint32_t flags)
+    {
+        if (flags & EPOLLERR)
+        {
+            closeConnection(conn);
+            return;
+        }
+
+        char chunk[kReadChunkSize];
+        bool peerClosed = false;
+        while (true)
+        {
+            ssize_t n = recv(conn->fd, chunk, sizeof(chunk), 0);
+            if (n > 0)
+            {
+                conn->buffer.append(chunk, static_cast<size_t>(n));
+                if (static_cast<size_t>(n) < sizeof(chunk))
+                {
+                    break;
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            peerClosed = true;
+            break;
+        }
+
+        conn->lastActive = std::chrono::steady_clock::now();
+
+        FrameStatus status = frameRequest(*conn);
+        switch (status)
+        {
+        case FrameStatus::Complete:
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            conn->busy = true;
+        }
+            dispatch(conn);
+            return;
+        case FrameStatus::Invalid:
+        case FrameStatus::Unsupported:
+        case FrameStatus::HeadersTooLarge:
+        case FrameStatus::BodyTooLarge:
+        {
+            // The connection is idle, so no earlier response is waiting to go out first
+            std::string_view rejection = frameRejection(status);
+            sendAll(conn->fd, rejection.data(), rejection.size());
+            closeConnection(conn);
+            return;
+        }
+        case FrameStatus::Incomplete:
+            break;
+        }
+
+        if (peerClosed)
+        {
+            closeConnection(conn);
+            return;
+        }
+
+        rearm(conn);
+    }
+
+    const std::atomic<bool>& running;
+    int idleTimeout;
+    RequestLimits limits;
+    DispatchFn dispatch;
+    std::chrono::steady_clock::time_point lastSweep = std::chrono::steady_clock::now();
+    int epollFd;
+    int wakeFd;
+    socket_t listenFd;
+    std::thread thread;
+    std::mutex mutex;
+    std::unordered_map<Connection*, std::unique_ptr<Connection>> connections;
+};
+
+#endif
+
+#ifdef BOSON_HAS_IO_URING
+
+/**
+ * @class IoUring
+ * @brief Minimal io_uring instance driven directly through the io_uring syscalls
+ *
+ * Owns the submission/completion rings and one provided-buffer group used by multishot recv.
+ */
+class IoUring
+{
+  public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring()
+    {
+        if (sqes != nullptr)
+        {
+            munmap(sqes, sqesSize);
+        }
+        if (ringPtr != nullptr)
+        {
+            munmap(ringPtr, ringSize);
+        }
+        if (ringFd >= 0)
+        {
+            close(ringFd);
+        }
+    }
+
+    bool open(unsigned entries)
+    {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+#ifdef IORING_SETUP_COOP_TASKRUN
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+#endif
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0 && errno == EINVAL)
+        {
+            memset(&params, 0, sizeof(params));
+            ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        }
+        if (ringFd < 0)
+        {
+            return false;
+        }
+
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG))
+        {
+            return false;
+        }
+
+        ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                            params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+        ringPtr = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                       IORING_OFF_SQ_RING);
+        if (ringPtr == MAP_FAILED)
+        {
+            ringPtr = nullptr;
+            return false;
+        }
+
+        sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqesPtr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ringFd, IORING_OFF_SQES);
+        if (sqesPtr == MAP_FAILED)
+        {
+            return false;
+        }
+        sqes = static_cast<struct io_uring_sqe*>(sqesPtr);
+
+        char* base = static_cast<char*>(ringPtr);
+        sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        sqTailPtr = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqTail = *sqTailPtr;
+
+        // Slots are used in order, so the indirection array is a fixed identity mapping
+        unsigned* array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        for (unsigned i = 0; i < sqEntries; i++)
+        {
+            array[i] = i;
+        }
+
+        cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe*>(base + params.cq_off.cqes);
+
+        return true;
+    }
+
+    /**
+     * @brief Hand a group of fixed-size receive buffers to the kernel for multishot recv
+     * @param groupId Buffer group the receives select from
+     * @param entries Number of buffers
+     * @param size Size of each buffer in bytes
+     *
+     * Uses IORING_OP_PROVIDE_BUFFERS rather than a registered buffer ring; it is supported on
+     * every kernel with multishot recv and recycling costs one batched SQE, not a syscall.
+     */
+    bool provideBuffers(unsigned short groupId, unsigned entries, size_t size)
+    {
+        bufGroup = groupId;
+        bufSize = size;
+        bufStorage.resize(entries * size);
+
+        struct io_uring_sqe* sqe = nextSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(entries);
+        sqe->addr = reinterpret_cast<uintptr_t>(bufStorage.data());
+        sqe->len = static_cast<unsigned>(size);
+        sqe->buf_group = groupId;
+        sqe->off = 0;
+        if (submit(1, -1) < 0)
+        {
+            return false;
+        }
+
+        int result = -1;
+        forEachCompletion([&](const struct io_uring_cqe& cqe) { result = cqe.res; });
+        return result >= 0;
+    }
+
+    const char* buffer(unsigned short id) const { return bufStorage.data() + id * bufSize; }
+
+    /**
+     * @brief Hand a consumed receive buffer back to the kernel with the next submission
+     *
+     * When the submission queue is full the buffer is kept aside and queued again after the
+     * next submit, so the group never loses it.
+     */
+    void recycleBuffer(unsigned short id)
+    {
+        if (!queueRecycle(id))
+        {
+            unrecycled.push_back(id);
+        }
+    }
+
+    /**
+     * @brief Get a zeroed submission slot, flushing the queue first if it is full
+     */
+    struct io_uring_sqe* nextSqe()
+    {
+        struct io_uring_sqe* sqe = freeSqe();
+        if (sqe == nullptr)
+        {
+            submit(0, -1);
+            sqe = freeSqe();
+        }
+        return sqe;
+    }
+
+    /**
+     * @brief Submit queued entries and optionally wait for completions
+     * @param waitFor Minimum number of completions to wait for
+     * @param timeoutMs Upper bound on the wait, or -1 to wait indefinitely
+     */
+    int submit(unsigned waitFor, int timeoutMs)
+    {
+        __atomic_store_n(sqTailPtr, sqTail, __ATOMIC_RELEASE);
+        unsigned pending = sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (pending == 0 && waitFor == 0)
+        {
+            return 0;
+        }
+
+        unsigned flags = 0;
+        void* arg = nullptr;
+        size_t argSize = 0;
+        struct __kernel_timespec ts;
+        struct io_uring_getevents_arg eventsArg;
+        if (waitFor > 0)
+        {
+            flags |= IORING_ENTER_GETEVENTS;
+            if (timeoutMs >= 0)
+            {
+                ts.tv_sec = timeoutMs / 1000;
+                ts.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+                memset(&eventsArg, 0, sizeof(eventsArg));
+                eventsArg.ts = reinterpret_cast<uintptr_t>(&ts);
+                flags |= IORING_ENTER_EXT_ARG;
+                arg = &eventsArg;
+                argSize = sizeof(eventsArg);
+            }
+        }
+
+        int result = static_cast<int>(
+            syscall(__NR_io_uring_enter, ringFd, pending, waitFor, flags, arg, argSize));
+
+        // The kernel has consumed entries, so buffers that found the queue full fit now
+        while (!unrecycled.empty() && queueRecycle(unrecycled.back()))
+        {
+            unrecycled.pop_back();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Invoke fn for every completion currently in the queue
+     */
+    template <typename Fn> void forEachCompletion(Fn&& fn)
+    {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            fn(cqes[head & cqMask]);
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+  private:
+    /**
+     * @brief Get a zeroed submission slot, or nullptr if the queue is full
+     */
+    struct io_uring_sqe* freeSqe()
+    {
+        if (sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+        {
+            return nullptr;
+        }
+        struct io_uring_sqe* sqe = &sqes[sqTail & sqMask];
+        memset(sqe, 0, sizeof(*sqe));
+        sqTail++;
+        return sqe;
+    }
+
+    /**
+     * @brief Queue the entry that gives a receive buffer back, without submitting
+     */
+    bool queueRecycle(unsigned short id)
+    {
+        struct io_uring_sqe* sqe = freeSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = 1;
+        sqe->addr = reinterpret_cast<uintptr_t>(bufStorage.data() + id * bufSize);
+        sqe->len = static_cast<unsigned>(bufSize);
+        sqe->buf_group = bufGroup;
+        sqe->off = id;
+        return true;
+    }
+
+    int ringFd = -1;
+    void* ringPtr = nullptr;
+    size_t ringSize = 0;
+    struct io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTailPtr = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned sqTail = 0;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    struct io_uring_cqe* cqes = nullptr;
+
+    unsigned short bufGroup = 0;
+    size_t bufSize = 0;
+    std::vector<char> bufStorage;
+    std::vector<unsigned short> unrecycled; ///< Consumed buffers still to be handed back
+};
+
+/**
+ * @class UringLoop
+ * @brief io_uring loop with multishot accept, provided-buffer multishot recv and linked sends
+ *
+ * Once a request is complete the loop hands the connection to the worker pool, as the epoll
+ * backend does, so handlers never block the ring. Large bodies, file bodies and streamed
+ * bodies are written by the worker; the responses it leaves in the output buffer are sent by
+ * the ring as one send chain when the worker returns the connection. A connection is either
+ * with a worker or has at most one send chain in flight, and requests that arrive meanwhile
+ * stay buffered until then, which keeps pipelined responses in order.
+ */
+class UringLoop
+{
+  public:
+    using DispatchFn = std::function<void(Connection*)>;
+
+    UringLoop(const std::atomic<bool>& running, int idleTimeoutSeconds,
+              const RequestLimits& limits, DispatchFn dispatch)
+        : running(running), idleTimeout(idleTimeoutSeconds), limits(limits),
+          dispatch(std::move(dispatch)), listenFd(-1), ownsListener(false), wakeFd(-1)
+    {
+    }
+
+    ~UringLoop()
+    {
+        for (auto& entry : connections)
+        {
+            close_socket(entry.second->fd);
+        }
+        if (ownsListener && listenFd >= 0)
+        {
+            close(listenFd);
+        }
+        if (wakeFd >= 0)
+        {
+            close(wakeFd);
+        }
+    }
+
+    /**
+     * @brief Create the ring; fails on kernels without the required io_uring features
+     */
+    bool open()
+    {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        return wakeFd >= 0 && ring.open(kRingEntries) &&
+               ring.provideBuffers(kBufferGroup, kRecvBuffers, kReadChunkSize);
+    }
+
+    /**
+     * @brief Start accepting on a listening socket
+     * @param owned Whether this loop closes the socket when it is destroyed
+     */
+    bool listen(socket_t fd, bool owned)
+    {
+        listenFd = fd;
+        ownsListener = owned;
+        return armAccept() && armWake();
+    }
+
+    void start() { thread = std::thread(&UringLoop::run, this); }
+
+    void stop()
+    {
+        wake();
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+
+    /**
+     * @brief Return a connection from a worker to this loop
+     * @param keepAlive False if the connection must be closed once its output has been sent
+     *
+     * Called on the worker's thread; the ring sends the output and resumes the connection.
+     */
+    void release(Connection* conn, bool keepAlive)
+    {
+        auto* uringConn = static_cast<UringConnection*>(conn);
+        uringConn->keepAlive = keepAlive;
+        {
+            std::lock_guard<std::mutex> lock(releasedMutex);
+            released.push_back(uringConn);
+        }
+        wake();
+    }
+
+  private:
+    static constexpr unsigned kRingEntries = 1024;
+    static constexpr unsigned kRecvBuffers = 128;
+    static constexpr unsigned short kBufferGroup = 0;
+
+    enum : uintptr_t
+    {
+        kTagIgnore = 0,
+        kTagAccept = 1,
+        kTagWake = 2,
+        kTagRecv = 3,
+        kTagSend = 4,
+        kTagShutdown = 5,
+        kTagMask = 7
+    };
+
+    struct UringConnection : Connection
+    {
+        using Connection::Connection;
+
+        std::string inflight;
+        std::string incoming; ///< Received while a worker owns the buffer
+        bool keepAlive = true;
+        unsigned pendingOps = 0;
+        bool recvArmed = false;
+        bool sending = false;
+        bool closing = false;
+        bool closeAfterSend = false;
+    };
+
+    void run()
+    {
+        auto lastSweep = std::chrono::steady_clock::now();
+
+        while (running)
+        {
+            int ret = ring.submit(1, 1000);
+            if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY)
+            {
+                std::cerr << "io_uring_enter failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            ring.forEachCompletion([this](const struct io_uring_cqe& cqe) { onCompletion(cqe); });
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastSweep >= std::chrono::seconds(1))
+            {
+                closeIdle(now);
+                lastSweep = now;
+            }
+        }
+    }
+
+    void onCompletion(const struct io_uring_cqe& cqe)
+    {
+        uintptr_t tag = cqe.user_data & kTagMask;
+        auto* conn = reinterpret_cast<UringConnection*>(cqe.user_data & ~kTagMask);
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+        switch (tag)
+        {
+        case kTagAccept:
+            if (cqe.res >= 0)
+            {
+                auto owned = std::make_unique<UringConnection>(limits);
+                owned->fd = cqe.res;
+                owned->loop = this;
+                owned->uring = true;
+                // Workers write large bodies with blocking sends; bound how long a stalled
+                // peer can hold one
+                struct timeval timeout = {kSendTimeoutMs / 1000, 0};
+                setsockopt(owned->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                UringConnection* raw = owned.get();
+                connections.emplace(raw, std::move(owned));
+                armRecv(raw);
+                maybeFree(raw);
+            }
+            if (!more)
+            {
+                armAccept();
+            }
+            break;
+        case kTagWake:
+        {
+            uint64_t value;
+            ssize_t ignored = ::read(wakeFd, &value, sizeof(value));
+            (void)ignored;
+            if (!more)
+            {
+                armWake();
+            }
+            resumeReleased();
+            break;
+        }
+        case kTagRecv:
+            onRecv(conn, cqe, more);
+            maybeFree(conn);
+            break;
+        case kTagSend:
+            onSend(conn, cqe);
+            maybeFree(conn);
+            break;
+        case kTagShutdown:
+            conn->pendingOps--;
+            maybeFree(conn);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void onRecv(UringConnection* conn, const struct io_uring_cqe& cqe, bool more)
+    {
+        if (!more)
+        {
+            conn->recvArmed = false;
+            conn->pendingOps--;
+        }
+
+        if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER))
+        {
+            auto id = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            std::string& target = conn->busy ? conn->incoming : conn->buffer;
+            target.append(ring.buffer(id), static_cast<size_t>(cqe.res));
+            ring.recycleBuffer(id);
+            conn->lastActive = std::chrono::steady_clock::now();
+
+            if (conn->closing)
+            {
+                return;
+            }
+            if (!conn->recvArmed)
+            {
+                armRecv(conn);
+            }
+            if (!conn->sending && !conn->busy)
+            {
+                serveBuffered(conn);
+            }
+            return;
+        }
+
+        if (cqe.res == -ENOBUFS && !conn->closing)
+        {
+            // Every receive buffer was in use; they are recycled as soon as data is copied out
+            if (!conn->recvArmed)
+            {
+                armRecv(conn);
+            }
+            return;
+        }
+
+        // Peer closed or the socket failed; let a response being built or sent finish first
+        if (conn->sending || conn->busy)
+        {
+            conn->closeAfterSend = true;
+        }
+        else
+        {
+            beginClose(conn);
+        }
+    }
+
+    void onSend(UringConnection* conn, const struct io_uring_cqe& cqe)
+    {
+        conn->pendingOps--;
+        conn->sending = false;
+
+        bool failed = cqe.res < 0 || static_cast<size_t>(cqe.res) < conn->inflight.size();
+        conn->inflight.clear();
+
+        if (failed || conn->closeAfterSend)
+        {
+            beginClose(conn);
+            return;
+        }
+
+        if (!conn->closing)
+        {
+            conn->lastActive = std::chrono::steady_clock::now();
+            serveBuffered(conn);
+        }
+    }
+
+    /**
+     * @brief Hand the connection to a worker if a complete request is buffered
+     */
+    void serveBuffered(UringConnection* conn)
+    {
+        FrameStatus status = frameRequest(*conn);
+        if (status == FrameStatus::Complete)
+        {
+            conn->busy = true;
+            dispatch(conn);
+        }
+        else if (isRejected(status))
+        {
+            conn->output.append(frameRejection(status));
+            submitSend(conn, true);
+        }
+        else if (conn->closeAfterSend)
+        {
+            beginClose(conn);
+        }
+    }
+
+    /**
+     * @brief Take back the connections workers have finished with and queue their responses
+     */
+    void resumeReleased()
+    {
+        {
+            std::lock_guard<std::mutex> lock(releasedMutex);
+            resuming.swap(released);
+        }
+        auto now = std::chrono::steady_clock::now();
+        for (UringConnection* conn : resuming)
+        {
+            conn->busy = false;
+            conn->lastActive = now;
+            conn->compact();
+            conn->buffer.append(conn->incoming);
+            conn->incoming.clear();
+
+            if (conn->closing)
+            {
+                // The receive could not be re-armed while the worker had the connection
+                maybeFree(conn);
+                continue;
+            }
+            if (!conn->output.empty())
+            {
+                submitSend(conn, !conn->keepAlive);
+            }
+            else if (!conn->keepAlive)
+            {
+                beginClose(conn);
+            }
+            else
+            {
+                serveBuffered(conn);
+            }
+            maybeFree(conn);
+        }
+        resuming.clear();
+    }
+
+    /**
+     * @brief Send the queued output, linking a shutdown behind it when the connection ends
+     */
+    void submitSend(UringConnection* conn, bool closeAfter)
+    {
+        struct io_uring_sqe* sqe = ring.nextSqe();
+        if (sqe == nullptr)
+        {
+            beginClose(conn);
+            return;
+        }
+
+        conn->inflight.swap(conn->output);
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn->fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(conn->inflight.data());
+        sqe->len = static_cast<unsigned>(conn->inflight.size());
+        sqe->msg_flags = BOSON_SEND_FLAGS | MSG_WAITALL;
+        sqe->user_data = reinterpret_cast<uintptr_t>(conn) | kTagSend;
+        conn->pendingOps++;
+        conn->sending = true;
+
+        if (!closeAfter)
+        {
+            return;
+        }
+
+        struct io_uring_sqe* shutdownSqe = ring.nextSqe();
+        if (shutdownSqe == nullptr)
+        {
+            conn->closeAfterSend = true;
+            return;
+        }
+        sqe->flags |= IOSQE_IO_LINK;
+        shutdownSqe->opcode = IORING_OP_SHUTDOWN;
+        shutdownSqe->fd = conn->fd;
+        shutdownSqe->len = SHUT_RDWR;
+        shutdownSqe->user_data = reinterpret_cast<uintptr_t>(conn) | kTagShutdown;
+        conn->pendingOps++;
+        conn->closing = true;
+    }
+
+    bool armAccept()
+    {
+        struct io_uring_sqe* sqe = ring.nextSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listenFd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        sqe->user_data = kTagAccept;
+        return true;
+    }
+
+    bool armWake()
+    {
+        struct io_uring_sqe* sqe = ring.nextSqe();
+        if (sqe == nullptr)
+        {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = wakeFd;
+        sqe->poll32_events = POLLIN;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->user_data = kTagWake;
+        return true;
+    }
+
+    void armRecv(UringConnection* conn)
+    {
+        struct io_uring_sqe* sqe = ring.nextSqe();
+        if (sqe == nullptr)
+        {
+            beginClose(conn);
+            return;
+        }
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = conn->fd;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->user_data = reinterpret_cast<uintptr_t>(conn) | kTagRecv;
+        conn->pendingOps++;
+        conn->recvArmed = true;
+    }
+
+    /**
+     * @brief Shut the socket down so the multishot recv terminates; the fd is closed once
+     *        no operation references the connection any more
+     */
+    void beginClose(UringConnection* conn)
+    {
+        conn->closing = true;
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+
+    void maybeFree(UringConnection* conn)
+    {
+        if (!conn->closing || conn->pendingOps > 0 || conn->busy)
+        {
+            return;
+        }
+
+        struct io_uring_sqe* sqe = ring.nextSqe();
+        if (sqe != nullptr)
+        {
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = conn->fd;
+            sqe->user_data = kTagIgnore;
+        }
+        else
+        {
+            close_socket(conn->fd);
+        }
+        connections.erase(conn);
+    }
+
+    void closeIdle(std::chrono::steady_clock::time_point now)
+    {
+        if (idleTimeout <= 0)
+        {
+            return;
+        }
+
+        auto limit = std::chrono::seconds(idleTimeout);
+        std::vector<UringConnection*> expired;
+        for (auto& entry : connections)
+        {
+            UringConnection* conn = entry.first;
+            if (!conn->busy && !conn->sending && !conn->closing &&
+                now - conn->lastActive > limit)
+            {
+                expired.push_back(conn);
+            }
+        }
+        for (UringConnection* conn : expired)
+        {
+            beginClose(conn);
+            maybeFree(conn);
+        }
+    }
+
+    void wake()
+    {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    const std::atomic<bool>& running;
+    int idleTimeout;
+    RequestLimits limits;
+    DispatchFn dispatch;
+    IoUring ring;
+    socket_t listenFd;
+    bool ownsListener;
+    int wakeFd;
+    std::thread thread;
+    std::unordered_map<UringConnection*, std::unique_ptr<UringConnection>> connections;
+    std::mutex releasedMutex;
+    std::vector<UringConnection*> released; ///< Returned by workers, guarded by releasedMutex
+    std::vector<UringConnection*> resuming;
+};
+
+#endif
+
+} // namespace
+
 class Server::Impl
 {
   public:
-    Impl() : running(false), port(3000), host("127.0.0.1"), serverSocket(SOCKET_ERROR_VALUE) {}
+    Impl()
+        : running(false), port(3000), host("127.0.0.1"), serverSocket(SOCKET_ERROR_VALUE),
+          keepAliveTimeout(5), maxRequestsPerConnection(1000), reusePort(false),
+          ioBackend(IoBackend::Epoll)
+    {
+    }
 
     ~Impl()
     {
@@ -66,75 +1557,267 @@ class Server::Impl
         return true;
     }
 
-    void cleanup()
+    void cleanup()
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    /**
+     * @brief Create a bound, listening socket for the configured host and port
+     * @param shared Whether other sockets may bind the same address with SO_REUSEPORT
+     */
+    socket_t openListener(bool shared)
+    {
+        socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd == SOCKET_ERROR_VALUE)
+        {
+            std::cerr << "Failed to create socket" << std::endl;
+            return SOCKET_ERROR_VALUE;
+        }
+
+        int opt = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
+
+#ifdef SO_REUSEPORT
+        if (shared && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char*)&opt, sizeof(opt)) < 0)
+        {
+            std::cerr << "Failed to enable SO_REUSEPORT" << std::endl;
+            close_socket(fd);
+            return SOCKET_ERROR_VALUE;
+        }
+#else
+        (void)shared;
+#endif
+
+        struct sockaddr_in serverAddr;
+        memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(port);
+
+        if (inet_pton(AF_INET, host.c_str(), &(serverAddr.sin_addr)) <= 0)
+        {
+            std::cerr << "Invalid address" << std::endl;
+            close_socket(fd);
+            return SOCKET_ERROR_VALUE;
+        }
+
+        if (bind(fd, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0)
+        {
+            std::cerr << "Failed to bind socket" << std::endl;
+            close_socket(fd);
+            return SOCKET_ERROR_VALUE;
+        }
+
+        if (::listen(fd, SOMAXCONN) < 0)
+        {
+            std::cerr << "Failed to listen on socket" << std::endl;
+            close_socket(fd);
+            return SOCKET_ERROR_VALUE;
+        }
+
+        return fd;
+    }
+
+    bool start(int port, const std::string& host)
+    {
+        this->port = port;
+        this->host = host;
+
+#ifdef BOSON_HAS_SENDFILE
+        // sendfile(2) has no MSG_NOSIGNAL; a peer reset must not kill the process
+        auto previousHandler = std::signal(SIGPIPE, SIG_IGN);
+        if (previousHandler != SIG_DFL && previousHandler != SIG_ERR)
+        {
+            std::signal(SIGPIPE, previousHandler);
+        }
+#endif
+
+#ifdef BOSON_HAS_IO_URING
+        if (ioBackend == IoBackend::IoUring)
+        {
+            if (startIoUring())
+            {
+                return true;
+            }
+            std::cerr << "io_uring is not available on this kernel, falling back to epoll"
+                      << std::endl;
+        }
+#else
+        if (ioBackend == IoBackend::IoUring)
+        {
+            std::cerr << "io_uring support is not compiled in, falling back to epoll" << std::endl;
+        }
+#endif
+
+#if defined(BOSON_HAS_EPOLL) && defined(SO_REUSEPORT)
+        if (reusePort)
+        {
+            return startReusePort();
+        }
+#else
+        if (reusePort)
+        {
+            std::cerr << "SO_REUSEPORT is not supported on this platform, using a single listener"
+                      << std::endl;
+        }
+#endif
+
+        serverSocket = openListener(false);
+        if (serverSocket == SOCKET_ERROR_VALUE)
+        {
+            return false;
+        }
+
+        running = true;
+
+        startWorkerThreads();
+
+#ifdef BOSON_HAS_EPOLL
+        if (!startEventLoops(false))
+        {
+            std::cerr << "Failed to start event loops" << std::endl;
+            stop();
+            return false;
+        }
+#endif
+
+        std::cout << "Server listening on " << host << ":" << port << std::endl;
+
+        acceptLoop();
+
+        return true;
+    }
+
+#if defined(BOSON_HAS_EPOLL) && defined(SO_REUSEPORT)
+    /**
+     * @brief Run one listener per event loop and let the kernel balance accepts between them
+     *
+     * Each loop accepts and reads its own connections, so there is no acceptor thread. Ready
+     * requests still go to the worker pool, so a handler that blocks holds up one worker
+     * rather than every connection of its loop.
+     */
+    bool startReusePort()
     {
-#ifdef _WIN32
-        WSACleanup();
-#endif
-    }
+        running = true;
 
-    bool start(int port, const std::string& host)
-    {
-        this->port = port;
-        this->host = host;
+        startWorkerThreads();
 
-        serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-        if (serverSocket == SOCKET_ERROR_VALUE)
+        if (!startEventLoops(true))
         {
-            std::cerr << "Failed to create socket" << std::endl;
+            std::cerr << "Failed to start event loops" << std::endl;
+            stop();
             return false;
         }
 
-        int opt = 1;
-        setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
+        std::cout << "Server listening on " << host << ":" << port << " (" << eventLoops.size()
+                  << " SO_REUSEPORT listeners)" << std::endl;
 
-        struct sockaddr_in serverAddr;
-        memset(&serverAddr, 0, sizeof(serverAddr));
-        serverAddr.sin_family = AF_INET;
-        serverAddr.sin_port = htons(port);
+        waitForStop();
 
-        if (inet_pton(AF_INET, host.c_str(), &(serverAddr.sin_addr)) <= 0)
+        return true;
+    }
+#endif
+
+#ifdef BOSON_HAS_IO_URING
+    /**
+     * @brief Serve through one io_uring loop per core
+     * @return False if the kernel lacks the required io_uring features, so the caller can fall
+     *         back to epoll before anything has been bound
+     */
+    bool startIoUring()
+    {
+        unsigned int numLoops = threadCount();
+        auto dispatch = [this](Connection* conn) { enqueue(conn); };
+
+        for (unsigned int i = 0; i < numLoops; i++)
         {
-            std::cerr << "Invalid address" << std::endl;
-            close_socket(serverSocket);
-            return false;
+            uringLoops.push_back(
+                std::make_unique<UringLoop>(running, keepAliveTimeout, requestLimits, dispatch));
+            if (!uringLoops.back()->open())
+            {
+                uringLoops.clear();
+                return false;
+            }
         }
 
-        if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0)
+        // Without SO_REUSEPORT every ring arms a multishot accept on the same listener
+        if (!reusePort)
         {
-            std::cerr << "Failed to bind socket" << std::endl;
-            close_socket(serverSocket);
-            return false;
+            serverSocket = openListener(false);
         }
-
-        if (::listen(serverSocket, SOMAXCONN) < 0)
+        for (auto& loop : uringLoops)
         {
-            std::cerr << "Failed to listen on socket" << std::endl;
-            close_socket(serverSocket);
-            return false;
+            socket_t fd = reusePort ? openListener(true) : serverSocket;
+            if (fd == SOCKET_ERROR_VALUE || !loop->listen(fd, reusePort))
+            {
+                uringLoops.clear();
+                if (serverSocket != SOCKET_ERROR_VALUE)
+                {
+                    close_socket(serverSocket);
+                    serverSocket = SOCKET_ERROR_VALUE;
+                }
+                return false;
+            }
         }
 
         running = true;
-
         startWorkerThreads();
+        for (auto& loop : uringLoops)
+        {
+            loop->start();
+        }
 
-        std::cout << "Server listening on " << host << ":" << port << std::endl;
+        std::cout << "Server listening on " << host << ":" << port << " (io_uring, "
+                  << uringLoops.size() << " rings)" << std::endl;
 
-        acceptLoop();
+        waitForStop();
 
         return true;
     }
+#endif
+
+    void waitForStop()
+    {
+        std::unique_lock<std::mutex> lock(stopMutex);
+        while (running)
+        {
+            stopCondition.wait_for(lock, std::chrono::seconds(1));
+        }
+    }
 
     void stop()
     {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(stopMutex);
+            running = false;
+        }
+        stopCondition.notify_all();
 
         if (serverSocket != SOCKET_ERROR_VALUE)
         {
+#ifndef _WIN32
+            shutdown(serverSocket, SHUT_RDWR);
+#endif
             close_socket(serverSocket);
             serverSocket = SOCKET_ERROR_VALUE;
         }
 
+#ifdef BOSON_HAS_EPOLL
+        for (auto& loop : eventLoops)
+        {
+            loop->stop();
+        }
+#endif
+
+#ifdef BOSON_HAS_IO_URING
+        for (auto& loop : uringLoops)
+        {
+            loop->stop();
+        }
+#endif
+
         std::unique_lock<std::mutex> lock(queueMutex);
         queueCondition.notify_all();
         lock.unlock();
@@ -149,11 +1832,28 @@ class Server::Impl
 
         workerThreads.clear();
 
+        // Event loops own their connections, so dropping them closes anything still queued
+#ifdef BOSON_HAS_EPOLL
+        readyQueue = std::queue<Connection*>();
+        eventLoops.clear();
+#ifdef BOSON_HAS_IO_URING
+        uringLoops.clear();
+#endif
+#else
+        while (!readyQueue.empty())
+        {
+            releaseConnection(readyQueue.front());
+            readyQueue.pop();
+        }
+#endif
+
         cleanup();
     }
 
     void acceptLoop()
     {
+        size_t nextLoop = 0;
+
         while (running)
         {
             struct sockaddr_in clientAddr;
@@ -171,22 +1871,34 @@ class Server::Impl
                 continue;
             }
 
+#ifdef BOSON_HAS_EPOLL
+            if (!setNonBlocking(clientSocket))
             {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                clientQueue.push(clientSocket);
+                close_socket(clientSocket);
+                continue;
             }
 
-            queueCondition.notify_one();
+            eventLoops[nextLoop]->addConnection(clientSocket);
+            nextLoop = (nextLoop + 1) % eventLoops.size();
+#else
+            (void)nextLoop;
+            setReceiveTimeout(clientSocket);
+            auto* conn = new Connection(requestLimits);
+            conn->fd = clientSocket;
+            enqueue(conn);
+#endif
         }
     }
 
-    void startWorkerThreads()
+    unsigned int threadCount() const
     {
         unsigned int numThreads = std::thread::hardware_concurrency();
-        if (numThreads == 0)
-        {
-            numThreads = 4;
-        }
+        return numThreads == 0 ? 4 : numThreads;
+    }
+
+    void startWorkerThreads()
+    {
+        unsigned int numThreads = threadCount();
 
         for (unsigned int i = 0; i < numThreads; i++)
         {
@@ -194,15 +1906,68 @@ class Server::Impl
         }
     }
 
+#ifdef BOSON_HAS_EPOLL
+    /**
+     * @brief Create one event loop per core
+     * @param ownListeners Give every loop its own SO_REUSEPORT listener
+     */
+    bool startEventLoops(bool ownListeners)
+    {
+        unsigned int numLoops = threadCount();
+        auto dispatch = [this](Connection* conn) { enqueue(conn); };
+
+        for (unsigned int i = 0; i < numLoops; i++)
+        {
+            eventLoops.push_back(
+                std::make_unique<EventLoop>(running, keepAliveTimeout, requestLimits, dispatch));
+            EventLoop& loop = *eventLoops.back();
+            if (!loop.open())
+            {
+                return false;
+            }
+
+            if (ownListeners)
+            {
+                socket_t fd = openListener(true);
+                if (fd == SOCKET_ERROR_VALUE)
+                {
+                    return false;
+                }
+                if (!setNonBlocking(fd) || !loop.addListener(fd))
+                {
+                    close_socket(fd);
+                    return false;
+                }
+            }
+        }
+
+        for (auto& loop : eventLoops)
+        {
+            loop->start();
+        }
+        return true;
+    }
+#endif
+
+    void enqueue(Connection* conn)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readyQueue.push(conn);
+        }
+
+        queueCondition.notify_one();
+    }
+
     void workerThread()
     {
         while (running)
         {
-            socket_t clientSocket;
+            Connection* conn;
 
             {
                 std::unique_lock<std::mutex> lock(queueMutex);
-                while (running && clientQueue.empty())
+                while (running && readyQueue.empty())
                 {
                     queueCondition.wait(lock);
                 }
@@ -212,127 +1977,247 @@ class Server::Impl
                     break;
                 }
 
-                clientSocket = clientQueue.front();
-                clientQueue.pop();
+                conn = readyQueue.front();
+                readyQueue.pop();
             }
 
-            handleClient(clientSocket);
-
-            close_socket(clientSocket);
+            serveConnection(conn);
         }
     }
 
-    void handleClient(socket_t clientSocket)
+    /**
+     * @brief Run every buffered request on a connection, then park or close it
+     */
+    void serveConnection(Connection* conn)
     {
-        constexpr int headerBufferSize = 8192;
-        char headerBuffer[headerBufferSize];
-        std::string requestData;
-        
-        int bytesRead = recv(clientSocket, headerBuffer, headerBufferSize - 1, 0);
-        if (bytesRead <= 0) {
+#ifndef BOSON_HAS_EPOLL
+        while (true)
+        {
+            FrameStatus status = frameRequest(*conn);
+            if (isRejected(status))
+            {
+                conn->output.append(frameRejection(status));
+                break;
+            }
+            if (status == FrameStatus::Incomplete)
+            {
+                // Answer everything pipelined so far before blocking for more input
+                if (!flushOutput(*conn))
+                {
+                    break;
+                }
+                conn->compact();
+                if (!readMore(*conn))
+                {
+                    break;
+                }
+                continue;
+            }
+
+            bool keepAlive = handleClient(*conn);
+            conn->consumeRequest();
+            if (!keepAlive)
+            {
+                break;
+            }
+        }
+        flushOutput(*conn);
+        releaseConnection(conn);
+#else
+        FrameStatus status;
+        bool keepAlive = serveBuffered(*conn, status);
+
+#ifdef BOSON_HAS_IO_URING
+        // The ring sends whatever output is left
+        if (conn->uring)
+        {
+            static_cast<UringLoop*>(conn->loop)->release(conn, keepAlive);
             return;
         }
-        
-        headerBuffer[bytesRead] = '\0';
-        requestData.append(headerBuffer, bytesRead);
-        
-        size_t headerEnd = requestData.find("\r\n\r\n");
-        if (headerEnd == std::string::npos) {
+#endif
+
+        bool flushed = flushOutput(*conn);
+        if (!keepAlive || !flushed)
+        {
+            releaseConnection(conn);
             return;
         }
-        
-        size_t contentLengthPos = requestData.find("Content-Length:");
-        size_t bodyLength = 0;
-        
-        if (contentLengthPos != std::string::npos) {
-            size_t valueStart = requestData.find_first_not_of(" \t", contentLengthPos + 15);
-            size_t valueEnd = requestData.find_first_of("\r\n", valueStart);
-            if (valueStart != std::string::npos && valueEnd != std::string::npos) {
-                try {
-                    bodyLength = std::stoul(requestData.substr(valueStart, valueEnd - valueStart));
-                } catch (...) { }
-            }
-        }
-        
-        size_t bodyRead = requestData.size() - (headerEnd + 4);
-        
-        if (bodyLength > bodyRead) {
-            size_t remainingBytes = bodyLength - bodyRead;
-            
-            char* bodyBuffer = new char[8192];
-            while (remainingBytes > 0) {
-                size_t chunkSize = (remainingBytes < 8192) ? remainingBytes : 8192;
-                bytesRead = recv(clientSocket, bodyBuffer, static_cast<int>(chunkSize), 0);
-                
-                if (bytesRead <= 0) {
-                    break;
-                }
-                
-                requestData.append(bodyBuffer, bytesRead);
-                remainingBytes -= bytesRead;
-            }
-            delete[] bodyBuffer;
-        }
-
-        Request request;
-        request.setRawRequest(requestData);
-        request.parse();
-        
-        std::string contentType = request.header("Content-Type");
-        if (contentType.find("multipart/form-data") != std::string::npos && bodyLength > 0) {
-            std::string body = requestData.substr(headerEnd + 4);
-            request.setBody(body);
-        }
-
-        Response response;
-        
-        bool isStreamingResponse = false;
-        bool hasStreamingStarted = false;
-        
-        response.setStreamCallback([&](const std::string& chunk) {
-            isStreamingResponse = true;
-            
-            if (!hasStreamingStarted) {
-                hasStreamingStarted = true;
-                
-                std::string headers;
-                std::stringstream ss;
-
-                auto responseHeaders = response.getHeaders();
-
-                ss << "HTTP/1.1 " << response.getStatusCode() << " ";
-                
-                auto statusTextIt = responseHeaders.find("Status-Text");
-                if (statusTextIt != responseHeaders.end()) {
-                    ss << statusTextIt->second;
-                } else {
-                    switch(response.getStatusCode()) {
-                        case 200: ss << "OK"; break;
-                        case 201: ss << "Created"; break;
-                        case 204: ss << "No Content"; break;
-                        case 400: ss << "Bad Request"; break;
-                        case 404: ss << "Not Found"; break;
-                        case 500: ss << "Internal Server Error"; break;
-                        default: ss << "Unknown"; break;
-                    }
+
+        conn->compact();
+        static_cast<EventLoop*>(conn->loop)->release(conn);
+#endif
+    }
+
+    /**
+     * @brief Handle every complete request buffered on a connection
+     * @param status Set to the framing state of whatever is left in the buffer
+     * @return False if the connection must be closed once its output has been written
+     */
+    bool serveBuffered(Connection& conn, FrameStatus& status)
+    {
+        bool keepAlive = true;
+        while ((status = frameRequest(conn)) == FrameStatus::Complete)
+        {
+            keepAlive = handleClient(conn);
+            conn.consumeRequest();
+            if (!keepAlive)
+            {
+                break;
+            }
+        }
+        if (isRejected(status))
+        {
+            // Queued behind the responses to the requests before it
+            conn.output.append(frameRejection(status));
+            return false;
+        }
+        return keepAlive;
+    }
+
+    /**
+     * @brief Decide whether the connection may carry another request after this one
+     */
+    bool shouldKeepAlive(const Request& request, Connection& conn) const
+    {
+        if (!running)
+        {
+            return false;
+        }
+        if (maxRequestsPerConnection > 0 && conn.requestCount >= maxRequestsPerConnection)
+        {
+            return false;
+        }
+
+        std::string connection(request.headerView(KnownHeader::Connection));
+        std::transform(connection.begin(), connection.end(), connection.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+
+        if (request.httpVersion() == "HTTP/1.1")
+        {
+            return connection.find("close") == std::string::npos;
+        }
+        return connection.find("keep-alive") != std::string::npos;
+    }
+
+#ifndef BOSON_HAS_EPOLL
+    void setReceiveTimeout(socket_t fd)
+    {
+        if (keepAliveTimeout <= 0)
+        {
+            return;
+        }
+#ifdef _WIN32
+        DWORD timeout = static_cast<DWORD>(keepAliveTimeout) * 1000;
+#else
+        struct timeval timeout;
+        timeout.tv_sec = keepAliveTimeout;
+        timeout.tv_usec = 0;
+#endif
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+    }
+#endif
+
+    void releaseConnection(Connection* conn)
+    {
+#ifdef BOSON_HAS_EPOLL
+        static_cast<EventLoop*>(conn->loop)->closeConnection(conn);
+#else
+        close_socket(conn->fd);
+        delete conn;
+#endif
+    }
+
+#ifndef BOSON_HAS_EPOLL
+    /**
+     * @brief Blocking read used on platforms without an event loop backend
+     */
+    bool readMore(Connection& conn)
+    {
+        char chunk[kReadChunkSize];
+        int bytesRead = recv(conn.fd, chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (bytesRead <= 0)
+        {
+            return false;
+        }
+        conn.buffer.append(chunk, bytesRead);
+        return true;
+    }
+#endif
+
+    /**
+     * @brief Handle the request framed at the front of the connection buffer
+     * @return True if the connection should stay open for another request
+     */
+    bool handleClient(Connection& conn)
+    {
+        socket_t clientSocket = conn.fd;
+        conn.requestCount++;
+
+        // The request and response are borrowed from this thread's pool and reset for the
+        // next request when the lease ends, keeping their buffers
+        RequestPool::Lease lease = RequestPool::local().acquire();
+        Request& request = lease.request();
+        Response& response = lease.response();
+
+        // The request views the connection buffer, which is not touched until it is handled
+        request.setParsedRequest(
+            std::string_view(conn.buffer).substr(conn.requestStart, conn.requestLength),
+            conn.parser);
+
+        bool keepAlive = shouldKeepAlive(request, conn);
+
+        // Everything the stream callback touches, so that it captures a single reference and
+        // std::function stores it without allocating
+        struct StreamState
+        {
+            Connection& conn;
+            Response& response;
+            bool& keepAlive;
+            const HeaderBlock& defaults;
+            bool streaming = false;
+            bool started = false;
+            bool failed = false; ///< A write failed; the rest of the body is dropped
+        } stream{conn, response, keepAlive, defaultHeaders};
+
+        response.setStreamCallback([&stream](const std::string& chunk) {
+            Connection& conn = stream.conn;
+            Response& response = stream.response;
+            bool& keepAlive = stream.keepAlive;
+            stream.streaming = true;
+            if (stream.failed) {
+                return;
+            }
+
+            if (!stream.started) {
+                stream.started = true;
+
+                // Without a length or chunked framing the body is delimited by closing
+                bool framed = response.hasHeader(KnownHeader::ContentLength) ||
+                              response.hasHeader(KnownHeader::TransferEncoding);
+                keepAlive = keepAlive && framed;
+                if (!response.hasHeader(KnownHeader::Connection)) {
+                    response.header("Connection", keepAlive ? "keep-alive" : "close");
                 }
-                ss << "\r\n";
+                response.writeStreamHead(conn.output, &stream.defaults);
 
-                for (const auto& header : responseHeaders) {
-                    if (header.first != "Status-Text") {
-                        ss << header.first << ": " << header.second << "\r\n";
-                    }
+                // Earlier pipelined responses must reach the client first
+                if (!flushOutput(conn)) {
+                    stream.failed = true;
+                    keepAlive = false;
+                    return;
                 }
+            }
 
-                ss << "\r\n";
-                headers = ss.str();
-                
-                send(clientSocket, headers.c_str(), headers.length(), 0);
+            if (!sendAll(conn.fd, chunk.c_str(), chunk.length())) {
+                stream.failed = true;
+                keepAlive = false;
             }
-            
-            send(clientSocket, chunk.c_str(), chunk.length(), 0);
         });
 
+        response.setCompressionContext(request.headerView(KnownHeader::AcceptEncoding),
+                                       compressionEnabled ? &compressionOptions : nullptr);
+
+        bool threw = false;
         try
         {
             bool continueProcessing = middlewareChain.execute(request, response);
@@ -343,12 +2228,21 @@ class Server::Impl
 
                 if (!handled)
                 {
+                    // A path routed only for other methods is a 405 rather than a 404
+                    std::string allow = router.allowedMethods(request.pathView());
+                    if (!allow.empty())
+                    {
+                        throw MethodNotAllowedError("Method not allowed: " + request.method() +
+                                                        " " + request.path(),
+                                                    allow);
+                    }
                     throw NotFoundError("Route not found: " + request.path());
                 }
             }
         }
         catch (const std::exception& e)
         {
+            threw = true;
             if (errorHandler)
             {
                 errorHandler(e, request, response);
@@ -359,11 +2253,92 @@ class Server::Impl
             }
         }
 
-        if (!isStreamingResponse) {
-            std::string rawResponse = response.getRawResponse();
-            send(clientSocket, rawResponse.c_str(), rawResponse.length(), 0);
+        if (stream.streaming && !response.streamEnded()) {
+            // A handler that returned without end() gets its body terminated. After an
+            // exception the head is already out, so the error response cannot be sent, and
+            // closing is the only way to tell the client the body is incomplete.
+            if (!threw) {
+                response.end();
+            }
+            if (!response.streamEnded()) {
+                keepAlive = false;
+            }
+        }
+        if (!stream.streaming) {
+            response.applyCompression();
+
+            std::string connectionHeader = response.getHeader("Connection");
+            if (connectionHeader.empty()) {
+                response.header("Connection", keepAlive ? "keep-alive" : "close");
+            } else if (connectionHeader == "close") {
+                keepAlive = false;
+            }
+
+#ifdef BOSON_HAS_SENDFILE
+            if (response.hasFileBody()) {
+                return sendFileResponse(conn, response) && keepAlive;
+            }
+#endif
+
+            // The head goes straight into the connection's output buffer behind any queued
+            // pipelined responses
+            response.writeHead(conn.output, &defaultHeaders);
+            std::string_view body = response.getBodyView();
+            if (body.size() < kInlineBodyLimit) {
+                conn.output.append(body.data(), body.size());
+                if (conn.output.size() >= kMaxPendingOutput && !flushOutput(conn)) {
+                    return false;
+                }
+            } else {
+                // Send the body straight out of the response rather than copying it
+                std::vector<std::string_view>& segments = conn.segments;
+                segments.clear();
+                segments.emplace_back(conn.output);
+                segments.emplace_back(body);
+                bool sent = sendSegments(clientSocket, segments);
+                conn.output.clear();
+                if (!sent) {
+                    return false;
+                }
+            }
+        }
+
+        return keepAlive;
+    }
+
+#ifdef BOSON_HAS_SENDFILE
+    /**
+     * @brief Send a response whose body is a file, after any pipelined output ahead of it
+     * @return False if the connection failed and must be closed
+     */
+    bool sendFileResponse(Connection& conn, const Response& response)
+    {
+        FileBody file = response.getFileBody();
+        response.writeHead(conn.output, &defaultHeaders);
+        if (file.chunked && file.length > 0)
+        {
+            char digits[16];
+            auto result = std::to_chars(digits, digits + sizeof(digits), file.length, 16);
+            conn.output.append(digits, static_cast<size_t>(result.ptr - digits));
+            conn.output += "\r\n";
+        }
+
+        std::vector<std::string_view>& segments = conn.segments;
+        segments.clear();
+        segments.emplace_back(conn.output);
+        bool sent = sendSegments(conn.fd, segments);
+        conn.output.clear();
+        if (!sent || !sendFileRegion(conn.fd, file.fd, file.offset, file.length))
+        {
+            return false;
+        }
+        if (file.chunked)
+        {
+            conn.output += file.length > 0 ? "\r\n0\r\n\r\n" : "0\r\n\r\n";
         }
+        return true;
     }
+#endif
 
     ErrorHandler errorHandler;
     Router router;
@@ -376,7 +2351,27 @@ class Server::Impl
     std::vector<std::thread> workerThreads;
     std::mutex queueMutex;
     std::condition_variable queueCondition;
-    std::queue<socket_t> clientQueue;
+    std::queue<Connection*> readyQueue;
+
+    int keepAliveTimeout;
+    size_t maxRequestsPerConnection;
+    RequestLimits requestLimits;
+    bool reusePort;
+    // Serialized once when set; read concurrently by the workers once listen() has started
+    HeaderBlock defaultHeaders;
+    bool compressionEnabled = false;
+    CompressionOptions compressionOptions;
+    IoBackend ioBackend;
+
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+
+#ifdef BOSON_HAS_EPOLL
+    std::vector<std::unique_ptr<EventLoop>> eventLoops;
+#endif
+#ifdef BOSON_HAS_IO_URING
+    std::vector<std::unique_ptr<UringLoop>> uringLoops;
+#endif
 };
 
 Server::Server() : pimpl(std::make_unique<Impl>())
@@ -395,6 +2390,8 @@ Server& Server::configure(int port, const std::string& host)
 
 int Server::listen()
 {
+    // Routes are final from here on, and every loop thread shares the frozen tables
+    pimpl->router.freeze();
     return pimpl->start(port, host) ? 0 : 1;
 }
 
@@ -457,4 +2454,53 @@ Server& Server::setErrorHandler(const ErrorHandler& handler)
     return *this;
 }
 
+Server& Server::setKeepAliveTimeout(int seconds)
+{
+    pimpl->keepAliveTimeout = seconds;
+    return *this;
+}
+
+Server& Server::setMaxRequestsPerConnection(size_t maxRequests)
+{
+    pimpl->maxRequestsPerConnection = maxRequests;
+    return *this;
+}
+
+Server& Server::setMaxHeaderSize(size_t bytes)
+{
+    pimpl->requestLimits.maxHeaderSize = bytes;
+    return *this;
+}
+
+Server& Server::setMaxBodySize(size_t bytes)
+{
+    pimpl->requestLimits.maxBodySize = bytes;
+    return *this;
+}
+
+Server& Server::setReusePort(bool enable)
+{
+    pimpl->reusePort = enable;
+    return *this;
+}
+
+Server& Server::setIoBackend(IoBackend backend)
+{
+    pimpl->ioBackend = backend;
+    return *this;
+}
+
+Server& Server::setCompression(const CompressionOptions& options)
+{
+    pimpl->compressionOptions = options;
+    pimpl->compressionEnabled = true;
+    return *this;
+}
+
+Server& Server::setDefaultHeader(const std::string& name, const std::string& value)
+{
+    pimpl->defaultHeaders.set(name, value);
+    return *this;
+}
+
 } // namespace boson
\ No newline at end of file
@@ -0,0 +1,490 @@
+#include "boson/static_file_cache.hpp"
+#include "boson/file_watcher.hpp"
+#include "boson/http_date.hpp"
+#include "boson/request.hpp"
+#include "boson/response.hpp"
+#include "boson/static_files.hpp"
+
+#include <any>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace boson
+{
+
+namespace
+{
+
+/**
+ * @brief A file as it is cached, shared with the responses that serve it
+ */
+struct CachedFile
+{
+    struct Variant
+    {
+        ContentEncoding encoding;
+        std::shared_ptr<const std::string> body;
+        std::string etag;
+    };
+
+    std::string key; ///< Path below the root; the index's key views it
+    std::shared_ptr<const std::string> body;
+    std::string etag;
+    std::string lastModified;
+    std::string contentType;
+    std::vector<Variant> variants; ///< In order of preference
+    size_t bytes = 0;              ///< Body and variants, as charged to the budget
+};
+
+/**
+ * @brief Get the suffix of a precompressed sibling file, or nullptr if the coding has none
+ */
+const char* siblingSuffix(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+    case ContentEncoding::Gzip:
+        return ".gz";
+    case ContentEncoding::Brotli:
+        return ".br";
+    case ContentEncoding::Zstd:
+        return ".zst";
+    default:
+        return nullptr;
+    }
+}
+
+bool readFile(const std::filesystem::path& path, std::uintmax_t size, std::string& content)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    content.resize(static_cast<size_t>(size));
+    return size == 0 ||
+           static_cast<bool>(file.read(&content[0], static_cast<std::streamsize>(size)));
+}
+
+/**
+ * @brief Check whether If-None-Match lists an entity tag, comparing weakly as RFC 9110 asks
+ */
+bool matchesEntityTag(std::string_view ifNoneMatch, std::string_view etag)
+{
+    while (!ifNoneMatch.empty())
+    {
+        size_t end = ifNoneMatch.find(',');
+        std::string_view tag = ifNoneMatch.substr(0, end);
+        while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t'))
+        {
+            tag.remove_prefix(1);
+        }
+        while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t'))
+        {
+            tag.remove_suffix(1);
+        }
+        if (tag.substr(0, 2) == "W/")
+        {
+            tag.remove_prefix(2);
+        }
+        if (tag == "*" || tag == etag)
+        {
+            return true;
+        }
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        ifNoneMatch.remove_prefix(end + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief Get the key a path below the root is cached under, as changed() computes it
+ * @param storage Holds the key when the path has to be normalised first
+ *
+ * Spellings such as "./app.js" and "css//site.css" must share one entry, or a change to the
+ * file would leave the copies cached under the other spellings in place.
+ */
+std::string_view cacheKey(std::string_view relativePath, std::string& storage)
+{
+    // Paths without empty or "." segments are already normal and are used as they are
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = relativePath.find('/', start);
+        std::string_view segment = relativePath.substr(start, end - start);
+        if (segment.empty() || segment == ".")
+        {
+            storage = std::filesystem::path(relativePath).lexically_normal().generic_string();
+            return storage;
+        }
+        if (end == std::string_view::npos)
+        {
+            return relativePath;
+        }
+        start = end + 1;
+    }
+}
+
+} // namespace
+
+class StaticFileCache::Impl
+{
+  public:
+    Impl(const std::string& root, const StaticFileCacheOptions& options)
+        : root(root), options(options)
+    {
+        if (options.watch)
+        {
+            watching = watcher.watch(this->root, true,
+                                     [this](const std::filesystem::path& path, bool directory) {
+                                         changed(path, directory);
+                                     });
+        }
+    }
+
+    struct Slot
+    {
+        std::shared_ptr<const CachedFile> file;
+        std::list<const CachedFile*>::iterator position;
+    };
+
+    std::filesystem::path root;
+    StaticFileCacheOptions options;
+
+    mutable std::mutex mutex;
+    // Keys view the cached file's own key, so looking a path up does not allocate
+    std::unordered_map<std::string_view, Slot> index;
+    std::list<const CachedFile*> recency; ///< Most recently served first
+    size_t bytes = 0;
+    // Advanced by every change on disk, so a file read while one happened is not cached
+    std::uint64_t generation = 0;
+    bool watching = false;
+    // Last, so its thread is joined before anything it touches is destroyed
+    FileWatcher watcher;
+
+    /**
+     * @brief Find a cached file and mark it as the most recently served
+     * @param key Path below the root
+     * @param seen Receives the generation the lookup saw, to pass to insert() on a miss
+     */
+    std::shared_ptr<const CachedFile> find(std::string_view key, std::uint64_t& seen)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen = generation;
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return nullptr;
+        }
+        recency.splice(recency.begin(), recency, it->second.position);
+        return it->second.file;
+    }
+
+    /**
+     * @brief Add a loaded file, evicting the least recently served ones to make room
+     * @param file The file
+     * @param seen The generation find() saw before the file was read; if something changed
+     *             on disk since, the file is served but not cached
+     * @return The file now cached under its key, which is an earlier copy if another thread
+     *         loaded it first
+     */
+    std::shared_ptr<const CachedFile> insert(std::shared_ptr<const CachedFile> file,
+                                             std::uint64_t seen)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(file->key);
+        if (it != index.end())
+        {
+            return it->second.file;
+        }
+        if (file->bytes > options.maxBytes || seen != generation)
+        {
+            return file;
+        }
+        while (bytes + file->bytes > options.maxBytes && !recency.empty())
+        {
+            eraseLocked(recency.back()->key);
+        }
+        recency.push_front(file.get());
+        index.emplace(file->key, Slot{file, recency.begin()});
+        bytes += file->bytes;
+        return file;
+    }
+
+    void eraseLocked(std::string_view key)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return;
+        }
+        // The key views the file, so the slot keeps it alive until the entry is gone
+        std::shared_ptr<const CachedFile> file = it->second.file;
+        bytes -= file->bytes;
+        recency.erase(it->second.position);
+        index.erase(it);
+    }
+
+    void clearLocked()
+    {
+        index.clear();
+        recency.clear();
+        bytes = 0;
+    }
+
+    /**
+     * @brief Drop whatever a change on disk may have made stale
+     */
+    void changed(const std::filesystem::path& path, bool directory)
+    {
+        std::string key = path.lexically_relative(root).generic_string();
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+        if (key.empty() || key == "." || key.compare(0, 2, "..") == 0)
+        {
+            clearLocked();
+            return;
+        }
+
+        eraseLocked(key);
+        if (directory)
+        {
+            key += '/';
+            for (auto it = recency.begin(); it != recency.end();)
+            {
+                const CachedFile* file = *it++;
+                if (file->key.compare(0, key.size(), key) == 0)
+                {
+                    eraseLocked(file->key);
+                }
+            }
+            return;
+        }
+        // A precompressed sibling is part of the file it belongs to
+        for (ContentEncoding encoding : options.compression.encodings)
+        {
+            const char* suffix = siblingSuffix(encoding);
+            size_t length = suffix ? std::char_traits<char>::length(suffix) : 0;
+            if (length > 0 && key.size() > length &&
+                key.compare(key.size() - length, length, suffix) == 0)
+            {
+                eraseLocked(std::string_view(key).substr(0, key.size() - length));
+            }
+        }
+    }
+
+    /**
+     * @brief Read a file and prepare everything needed to serve it
+     * @param key Path below the root
+     * @param path The file
+     * @param size Its size
+     * @param modified Its modification time
+     */
+    std::shared_ptr<CachedFile> load(std::string_view key, const std::filesystem::path& path,
+                                     std::uintmax_t size,
+                                     std::filesystem::file_time_type modified) const
+    {
+        std::string content;
+        if (!readFile(path, size, content))
+        {
+            return nullptr;
+        }
+
+        auto file = std::make_shared<CachedFile>();
+        file->key = std::string(key);
+        file->contentType = StaticFiles::getContentType(path.extension().string());
+        file->etag = "\"" +
+                     std::to_string(static_cast<long long>(modified.time_since_epoch().count())) +
+                     "-" + std::to_string(static_cast<unsigned long long>(size)) + "\"";
+
+        char date[kHttpDateLength];
+        formatHttpDate(modified, date);
+        file->lastModified.assign(date, kHttpDateLength);
+
+        bool compress = options.precompress &&
+                        options.compression.compressible(file->contentType) &&
+                        content.size() >= options.compression.minSize;
+        for (ContentEncoding encoding : options.compression.encodings)
+        {
+            std::string variant;
+            if (!loadSibling(path, encoding, modified, variant) &&
+                !(compress && contentEncodingAvailable(encoding) &&
+                  Compressor::local().compress(encoding, content, variant,
+                                               options.compression.level) &&
+                  variant.size() < content.size()))
+            {
+                continue;
+            }
+            std::string etag = file->etag;
+            etag.insert(etag.size() - 1, "-");
+            etag.insert(etag.size() - 1, contentEncodingName(encoding));
+            file->bytes += variant.size();
+            file->variants.push_back(CachedFile::Variant{
+                encoding, std::make_shared<const std::string>(std::move(variant)),
+                std::move(etag)});
+        }
+
+        file->bytes += content.size();
+        file->body = std::make_shared<const std::string>(std::move(content));
+        return file;
+    }
+
+    /**
+     * @brief Read the precompressed sibling of a file for a coding, if there is a current one
+     */
+    bool loadSibling(const std::filesystem::path& path, ContentEncoding encoding,
+                     std::filesystem::file_time_type modified, std::string& content) const
+    {
+        const char* suffix = siblingSuffix(encoding);
+        if (!options.precompressedFiles || !suffix)
+        {
+            return false;
+        }
+        std::filesystem::path sibling = path;
+        sibling += suffix;
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(sibling, error) ||
+            std::filesystem::last_write_time(sibling, error) < modified || error)
+        {
+            return false;
+        }
+        std::uintmax_t size = std::filesystem::file_size(sibling, error);
+        return !error && readFile(sibling, size, content);
+    }
+};
+
+StaticFileCache::StaticFileCache(const std::string& root, const StaticFileCacheOptions& options)
+    : pimpl(std::make_unique<Impl>(root, options))
+{
+}
+
+StaticFileCache::~StaticFileCache() = default;
+
+bool StaticFileCache::serve(const Request& request, Response& response,
+                            std::string_view relativePath)
+{
+    if (!StaticFiles::isSafePath(relativePath))
+    {
+        return false;
+    }
+    std::string normalized;
+    relativePath = cacheKey(relativePath, normalized);
+
+    std::uint64_t generation = 0;
+    std::shared_ptr<const CachedFile> file = pimpl->find(relativePath, generation);
+    if (!file)
+    {
+        std::filesystem::path path = pimpl->root / std::filesystem::path(relativePath);
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(path, error))
+        {
+            return false;
+        }
+        std::uintmax_t size = std::filesystem::file_size(path, error);
+        std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+        if (error)
+        {
+            return false;
+        }
+        if (size > pimpl->options.maxFileSize)
+        {
+            std::map<std::string, std::any> fileOptions;
+            if (!pimpl->options.cacheControl.empty())
+            {
+                fileOptions["cacheControl"] = pimpl->options.cacheControl;
+            }
+            response.sendFile(path.string(), fileOptions);
+            return true;
+        }
+        std::shared_ptr<CachedFile> loaded = pimpl->load(relativePath, path, size, modified);
+        if (!loaded)
+        {
+            return false;
+        }
+        file = pimpl->insert(std::move(loaded), generation);
+    }
+
+    // The client's most preferred variant, ties going to the cache's order
+    const CachedFile::Variant* chosen = nullptr;
+    if (!file->variants.empty())
+    {
+        std::string_view acceptEncoding = request.headerView(KnownHeader::AcceptEncoding);
+        double bestQuality = 0.0;
+        for (const CachedFile::Variant& variant : file->variants)
+        {
+            double quality = acceptQuality(acceptEncoding, variant.encoding);
+            if (quality > bestQuality)
+            {
+                chosen = &variant;
+                bestQuality = quality;
+            }
+        }
+        response.header(KnownHeader::Vary, "Accept-Encoding");
+    }
+    const std::string& etag = chosen ? chosen->etag : file->etag;
+
+    response.header(KnownHeader::ETag, etag);
+    response.header(KnownHeader::LastModified, file->lastModified);
+    if (!pimpl->options.cacheControl.empty())
+    {
+        response.header(KnownHeader::CacheControl, pimpl->options.cacheControl);
+    }
+
+    std::string_view ifNoneMatch = request.headerView(KnownHeader::IfNoneMatch);
+    bool notModified = !ifNoneMatch.empty()
+                           ? matchesEntityTag(ifNoneMatch, etag)
+                           : request.headerView(KnownHeader::IfModifiedSince) ==
+                                 std::string_view(file->lastModified);
+    if (notModified)
+    {
+        response.status(304);
+        response.send("");
+        return true;
+    }
+
+    response.header(KnownHeader::ContentType, file->contentType);
+    if (chosen)
+    {
+        response.header(KnownHeader::ContentEncoding, contentEncodingName(chosen->encoding));
+    }
+    response.sendShared(chosen ? chosen->body : file->body);
+    return true;
+}
+
+void StaticFileCache::invalidate(std::string_view relativePath)
+{
+    std::string normalized;
+    std::string_view key = cacheKey(relativePath, normalized);
+    std::lock_guard<std::mutex> lock(pimpl->mutex);
+    pimpl->generation++;
+    pimpl->eraseLocked(key);
+}
+
+void StaticFileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(pimpl->mutex);
+    pimpl->generation++;
+    pimpl->clearLocked();
+}
+
+bool StaticFileCache::watching() const
+{
+    return pimpl->watching;
+}
+
+size_t StaticFileCache::size() const
+{
+    std::lock_guard<std::mutex> lock(pimpl->mutex);
+    return pimpl->bytes;
+}
+
+} // namespace boson
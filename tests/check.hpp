@@ -0,0 +1,59 @@
+#ifndef BOSON_TESTS_CHECK_HPP
+#define BOSON_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Minimal assertions shared by the test executables
+ *
+ * A failed CHECK prints its expression, location and the current context, then the test
+ * carries on so that one run lists every failure. main() returns result() to tell CTest
+ * whether anything failed.
+ */
+namespace boson_test
+{
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief What is being checked, printed with each failure, e.g. the kernel and split offset
+ */
+inline std::string& context()
+{
+    static std::string current;
+    return current;
+}
+
+inline bool check(bool ok, const char* expression, const char* file, int line)
+{
+    if (!ok)
+    {
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed%s%s\n", file, line, expression,
+                     context().empty() ? "" : " in ", context().c_str());
+        failures()++;
+    }
+    return ok;
+}
+
+inline int result(const char* name)
+{
+    if (failures() > 0)
+    {
+        std::fprintf(stderr, "%s: %d checks failed\n", name, failures());
+        return 1;
+    }
+    std::printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+} // namespace boson_test
+
+#define CHECK(expression)                                                                      \
+    ::boson_test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,483 @@
+/**
+ * @file http_parser_test.cpp
+ * @brief HttpParser framing with every scanning kernel and every split of the input
+ *
+ * Each request is parsed whole with the scalar kernel to get the expected result, then again
+ * with every kernel the CPU supports, split at each byte offset and fed one byte at a time
+ * from a buffer that moves between calls. Also covers the header block and body limits and
+ * how Content-Length and Transfer-Encoding frame, or refuse to frame, a body.
+ */
+
+#include "check.hpp"
+
+#include "boson/http_parser.hpp"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using boson::HttpParser;
+using boson::ScanKernel;
+using Status = HttpParser::Status;
+
+const char* kernelName(ScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case ScanKernel::Scalar:
+        return "scalar";
+    case ScanKernel::Sse42:
+        return "sse4.2";
+    case ScanKernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+std::vector<ScanKernel> supportedKernels()
+{
+    std::vector<ScanKernel> kernels;
+    for (ScanKernel kernel : {ScanKernel::Scalar, ScanKernel::Sse42, ScanKernel::Avx2})
+    {
+        if (HttpParser::setScanKernel(kernel))
+        {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+/**
+ * @brief Everything a parse produced, resolved against the message so results compare
+ */
+struct Parsed
+{
+    Status status = Status::Incomplete;
+    std::string method;
+    std::string target;
+    std::string path;
+    std::string query;
+    std::string version;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    size_t messageLength = 0;
+
+    bool operator==(const Parsed& other) const
+    {
+        return status == other.status && method == other.method && target == other.target &&
+               path == other.path && query == other.query && version == other.version &&
+               headers == other.headers && body == other.body &&
+               messageLength == other.messageLength;
+    }
+};
+
+Parsed snapshot(const HttpParser& parser, Status status, const std::string& message)
+{
+    Parsed parsed;
+    parsed.status = status;
+    if (status != Status::Complete)
+    {
+        return parsed;
+    }
+    const char* data = message.data();
+    parsed.method = std::string(parser.method().in(data));
+    parsed.target = std::string(parser.target().in(data));
+    parsed.path = std::string(parser.path().in(data));
+    parsed.query = std::string(parser.query().in(data));
+    parsed.version = std::string(parser.version().in(data));
+    for (const auto& field : parser.headers())
+    {
+        parsed.headers.emplace_back(field.name.in(data), field.value.in(data));
+    }
+    parsed.body = std::string(parser.body().in(data));
+    parsed.messageLength = parser.messageLength();
+    return parsed;
+}
+
+Parsed parseWhole(const std::string& message, size_t maxHeaderSize = 65536)
+{
+    HttpParser parser(maxHeaderSize);
+    Status status = parser.parse(message.data(), message.size());
+    return snapshot(parser, status, message);
+}
+
+/**
+ * @brief Requests whose last byte completes them, so every shorter prefix is Incomplete
+ */
+std::vector<std::string> wellFormedRequests()
+{
+    std::vector<std::string> requests = {
+        "GET / HTTP/1.1\r\n\r\n",
+        "GET /users/42?sort=name&limit=10 HTTP/1.1\r\nHost: localhost:3000\r\n"
+        "Accept: */*\r\n\r\n",
+        "POST /echo HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\n"
+        "Content-Length: 11\r\n\r\nhello world",
+        "GET /lf HTTP/1.0\nHost: localhost\nConnection: keep-alive\n\n",
+        "\r\n\r\nGET /after-blank-lines HTTP/1.1\r\nHost: x\r\n\r\n",
+        "GET /? HTTP/1.1\r\nX-Empty:\r\nX-Padded: \t value \t\r\n\r\n",
+        "PUT /items/7 HTTP/1.1\r\ncontent-LENGTH: 007\r\n\r\n{\"a\":1}",
+    };
+
+    // Delimiters at every position within 16- and 32-byte blocks
+    std::string padded = "GET /" + std::string(70, 'p') + "?" + std::string(33, 'q') +
+                         " HTTP/1.1\r\n";
+    for (size_t length = 0; length <= 70; length++)
+    {
+        padded += "X-Pad-" + std::string(length % 37, 'n') + ": " +
+                  std::string(length, static_cast<char>('a' + length % 26)) + "\r\n";
+    }
+    padded += "Content-Length: 3\r\n\r\nend";
+    requests.push_back(padded);
+    return requests;
+}
+
+void testSplits()
+{
+    std::vector<std::string> requests = wellFormedRequests();
+    HttpParser::setScanKernel(ScanKernel::Scalar);
+    std::vector<Parsed> expected;
+    for (const std::string& request : requests)
+    {
+        expected.push_back(parseWhole(request));
+        CHECK(expected.back().status == Status::Complete);
+        CHECK(expected.back().messageLength == request.size());
+    }
+
+    for (ScanKernel kernel : supportedKernels())
+    {
+        HttpParser::setScanKernel(kernel);
+        for (size_t r = 0; r < requests.size(); r++)
+        {
+            const std::string& request = requests[r];
+            boson_test::context() =
+                std::string(kernelName(kernel)) + ", request " + std::to_string(r);
+            CHECK(parseWhole(request) == expected[r]);
+
+            // Split once at every offset; the rest arrives in a reallocated buffer
+            for (size_t split = 0; split < request.size(); split++)
+            {
+                HttpParser parser;
+                std::string first = request.substr(0, split);
+                if (!CHECK(parser.parse(first.data(), first.size()) == Status::Incomplete))
+                {
+                    break;
+                }
+                std::string whole(request);
+                Status status = parser.parse(whole.data(), whole.size());
+                if (!CHECK(snapshot(parser, status, whole) == expected[r]))
+                {
+                    break;
+                }
+            }
+
+            // One byte at a time, the buffer growing and moving as it would on a connection
+            HttpParser parser;
+            std::string received;
+            Status status = Status::Incomplete;
+            for (size_t i = 0; i < request.size(); i++)
+            {
+                received.push_back(request[i]);
+                received.shrink_to_fit();
+                status = parser.parse(received.data(), received.size());
+                if (i + 1 < request.size() && !CHECK(status == Status::Incomplete))
+                {
+                    break;
+                }
+            }
+            CHECK(snapshot(parser, status, received) == expected[r]);
+        }
+    }
+    boson_test::context().clear();
+}
+
+/**
+ * @brief Deterministic generator so failures reproduce
+ */
+struct Random
+{
+    uint64_t state;
+
+    uint32_t next(uint32_t bound)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33) % bound;
+    }
+};
+
+std::string randomRequest(Random& random)
+{
+    static const std::string kTokenChars =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~!#$%&'*+^`|";
+    static const std::string kValueChars = kTokenChars + " \t/:;,=?@()[]{}\"<>\\";
+
+    std::string request = random.next(2) ? "GET /" : "DELETE /";
+    for (uint32_t i = random.next(80); i > 0; i--)
+    {
+        request += kTokenChars[random.next(static_cast<uint32_t>(kTokenChars.size()))];
+    }
+    request += " HTTP/1.1\r\n";
+    for (uint32_t header = random.next(12); header > 0; header--)
+    {
+        for (uint32_t i = 1 + random.next(40); i > 0; i--)
+        {
+            request += kTokenChars[random.next(static_cast<uint32_t>(kTokenChars.size()))];
+        }
+        request += ": ";
+        for (uint32_t i = random.next(90); i > 0; i--)
+        {
+            request += kValueChars[random.next(static_cast<uint32_t>(kValueChars.size()))];
+        }
+        request += "\r\n";
+    }
+    request += "\r\n";
+
+    // Some requests get a byte that must stop a kernel early and fail the request
+    if (random.next(3) == 0)
+    {
+        static const char kBadBytes[] = {'\x01', '\x7f', ' ', '\t', '\0', '\x1f'};
+        size_t position = 5 + random.next(static_cast<uint32_t>(request.size() - 9));
+        request[position] = kBadBytes[random.next(sizeof(kBadBytes))];
+    }
+    return request;
+}
+
+void testKernelsAgree()
+{
+    Random random{42};
+    std::vector<ScanKernel> kernels = supportedKernels();
+    for (int i = 0; i < 3000; i++)
+    {
+        std::string request = randomRequest(random);
+        HttpParser::setScanKernel(ScanKernel::Scalar);
+        Parsed expected = parseWhole(request);
+        for (ScanKernel kernel : kernels)
+        {
+            HttpParser::setScanKernel(kernel);
+            boson_test::context() =
+                std::string(kernelName(kernel)) + ", random request " + std::to_string(i);
+            CHECK(parseWhole(request) == expected);
+
+            HttpParser parser;
+            size_t split = random.next(static_cast<uint32_t>(request.size()));
+            Status first = parser.parse(request.data(), split);
+            Status status =
+                first == Status::Incomplete ? parser.parse(request.data(), request.size()) : first;
+            CHECK(snapshot(parser, status, request) == expected);
+        }
+    }
+    boson_test::context().clear();
+}
+
+void testHeaderLimit()
+{
+    const size_t limit = 128;
+    std::string head = "GET / HTTP/1.1\r\nX-Fill: ";
+    std::string fitting = head + std::string(limit - head.size() - 4, 'f') + "\r\n\r\n";
+    std::string tooLong = head + std::string(limit - head.size() - 3, 'f') + "\r\n\r\n";
+    CHECK(fitting.size() == limit);
+
+    for (ScanKernel kernel : supportedKernels())
+    {
+        HttpParser::setScanKernel(kernel);
+        boson_test::context() = kernelName(kernel);
+
+        CHECK(parseWhole(fitting, limit).status == Status::Complete);
+        CHECK(parseWhole(tooLong, limit).status == Status::HeadersTooLarge);
+
+        // An unterminated header block fails as soon as it reaches the limit
+        HttpParser parser(limit);
+        std::string endless = head + std::string(400, 'f');
+        CHECK(parser.parse(endless.data(), limit - 1) == Status::Incomplete);
+        CHECK(parser.parse(endless.data(), limit) == Status::HeadersTooLarge);
+
+        // Many short headers count towards the same limit
+        std::string many = "GET / HTTP/1.1\r\n";
+        while (many.size() < limit)
+        {
+            many += "A: b\r\n";
+        }
+        many += "\r\n";
+        CHECK(parseWhole(many, limit).status == Status::HeadersTooLarge);
+
+        // The body is not part of the limit
+        std::string body(limit * 4, 'b');
+        std::string post = "POST / HTTP/1.1\r\nContent-Length: " + std::to_string(body.size()) +
+                           "\r\n\r\n" + body;
+        Parsed parsed = parseWhole(post, limit);
+        CHECK(parsed.status == Status::Complete);
+        CHECK(parsed.body == body);
+    }
+    boson_test::context().clear();
+}
+
+std::string withHeaders(const std::string& headers, const std::string& body = "")
+{
+    return "POST /upload HTTP/1.1\r\nHost: x\r\n" + headers + "\r\n" + body;
+}
+
+void testBodyLimit()
+{
+    const size_t limit = 10;
+    std::string fitting = withHeaders("Content-Length: 10\r\n", "0123456789");
+    HttpParser parser(65536, limit);
+    CHECK(parser.parse(fitting.data(), fitting.size()) == Status::Complete);
+
+    // Refused as soon as the header block ends, before any of the body has arrived
+    std::string tooLarge = withHeaders("Content-Length: 11\r\n");
+    HttpParser refusing(65536, limit);
+    CHECK(refusing.parse(tooLarge.data(), tooLarge.size()) == Status::BodyTooLarge);
+
+    // Malformed framing is still reported as such
+    std::string both = withHeaders("Content-Length: 11\r\nTransfer-Encoding: chunked\r\n");
+    HttpParser framing(65536, limit);
+    CHECK(framing.parse(both.data(), both.size()) == Status::Invalid);
+}
+
+void testContentLength()
+{
+    struct Case
+    {
+        const char* value;
+        Status status;
+        size_t length;
+    };
+    const Case cases[] = {
+        {"0", Status::Complete, 0},
+        {"5", Status::Complete, 5},
+        {"0005", Status::Complete, 5},
+        {"5 \t", Status::Complete, 5},
+        {"", Status::Invalid, 0},
+        {"-1", Status::Invalid, 0},
+        {"+5", Status::Invalid, 0},
+        {"5,5", Status::Invalid, 0},
+        {"5 5", Status::Invalid, 0},
+        {"0x5", Status::Invalid, 0},
+        {"5a", Status::Invalid, 0},
+        {"99999999999999999999999999", Status::Invalid, 0},
+    };
+
+    for (const Case& test : cases)
+    {
+        boson_test::context() = std::string("Content-Length: '") + test.value + "'";
+        std::string request =
+            withHeaders(std::string("Content-Length: ") + test.value + "\r\n", "hello");
+        HttpParser parser;
+        Status status = parser.parse(request.data(), request.size());
+        CHECK(status == test.status);
+        if (status == Status::Complete)
+        {
+            CHECK(parser.body().length == test.length);
+            CHECK(parser.messageLength() == parser.headerLength() + test.length);
+        }
+    }
+    boson_test::context().clear();
+
+    // The body completes the request only once all of it has arrived, and bytes after it are
+    // left for the next request
+    std::string request = withHeaders("Content-Length: 10\r\n", "0123456789GET / HTTP/1.1");
+    size_t headerLength = request.find("\r\n\r\n") + 4;
+    HttpParser parser;
+    CHECK(parser.parse(request.data(), headerLength + 9) == Status::Incomplete);
+    CHECK(parser.parse(request.data(), request.size()) == Status::Complete);
+    CHECK(parser.messageLength() == headerLength + 10);
+    CHECK(parser.body().in(request.data()) == "0123456789");
+
+    // Without Content-Length there is no body, even if bytes follow
+    HttpParser bodiless;
+    std::string get = "GET / HTTP/1.1\r\n\r\nextra";
+    CHECK(bodiless.parse(get.data(), get.size()) == Status::Complete);
+    CHECK(bodiless.messageLength() == get.size() - 5);
+}
+
+void testFramingHeaders()
+{
+    struct Case
+    {
+        const char* headers;
+        Status status;
+    };
+    const Case cases[] = {
+        {"Content-Length: 5\r\nContent-Length: 5\r\n", Status::Complete},
+        {"Content-Length: 5\r\ncontent-length: 05\r\n", Status::Complete},
+        {"Content-Length: 5\r\nContent-Length: 6\r\n", Status::Invalid},
+        {"Content-Length: 5\r\nContent-Length: \r\n", Status::Invalid},
+        {"Transfer-Encoding: chunked\r\n", Status::Unsupported},
+        {"transfer-encoding: identity\r\n", Status::Unsupported},
+        {"Transfer-Encoding: gzip, chunked\r\n", Status::Unsupported},
+        {"Transfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n", Status::Unsupported},
+        {"Content-Length: 5\r\nTransfer-Encoding: chunked\r\n", Status::Invalid},
+        {"Transfer-Encoding: chunked\r\nContent-Length: 5\r\n", Status::Invalid},
+        {"TRANSFER-ENCODING: chunked\r\nContent-Length: 0\r\n", Status::Invalid},
+    };
+
+    for (ScanKernel kernel : supportedKernels())
+    {
+        HttpParser::setScanKernel(kernel);
+        for (const Case& test : cases)
+        {
+            boson_test::context() = std::string(kernelName(kernel)) + ", " + test.headers;
+            std::string request = withHeaders(test.headers, "hello0\r\n\r\n");
+            CHECK(parseWhole(request).status == test.status);
+
+            // Refused only once the header block is complete, whatever the split
+            size_t headerLength = request.find("\r\n\r\n") + 4;
+            for (size_t split = 0; split < headerLength; split++)
+            {
+                HttpParser parser;
+                CHECK(parser.parse(request.data(), split) == Status::Incomplete);
+                CHECK(parser.parse(request.data(), request.size()) == test.status);
+            }
+        }
+    }
+    boson_test::context().clear();
+}
+
+void testPipelined()
+{
+    std::string requests = "GET /first HTTP/1.1\r\nHost: x\r\n\r\n"
+                           "POST /second HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+                           "GET /third HTTP/1.1\r\n\r\n";
+    const char* expectedPaths[] = {"/first", "/second", "/third"};
+
+    HttpParser parser;
+    size_t start = 0;
+    for (const char* path : expectedPaths)
+    {
+        const char* message = requests.data() + start;
+        CHECK(parser.parse(message, requests.size() - start) == Status::Complete);
+        CHECK(parser.path().in(message) == path);
+        start += parser.messageLength();
+        parser.reset();
+    }
+    CHECK(start == requests.size());
+
+    // A completed message stays complete when more bytes arrive behind it
+    size_t firstLength = requests.find("POST");
+    HttpParser again;
+    CHECK(again.parse(requests.data(), firstLength) == Status::Complete);
+    CHECK(again.parse(requests.data(), requests.size()) == Status::Complete);
+    CHECK(again.messageLength() == firstLength);
+}
+
+} // namespace
+
+int main()
+{
+    ScanKernel detected = boson::HttpParser::scanKernel();
+    std::printf("detected scan kernel: %s\n", kernelName(detected));
+
+    testSplits();
+    testKernelsAgree();
+    testHeaderLimit();
+    testContentLength();
+    testBodyLimit();
+    testFramingHeaders();
+    testPipelined();
+
+    HttpParser::setScanKernel(detected);
+    return boson_test::result("http_parser_test");
+}
@@ -0,0 +1,164 @@
+/**
+ * @file router_test.cpp
+ * @brief Dispatch through mounted routers and controller bindings, and the path and parameters
+ * handlers see
+ */
+
+#include "check.hpp"
+
+#include "boson/request.hpp"
+#include "boson/response.hpp"
+#include "boson/route_binder.hpp"
+#include "boson/router.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+void parseRequest(boson::Request& request, const std::string& method, const std::string& target)
+{
+    request.reset();
+    request.setRawRequest(method + " " + target + " HTTP/1.1\r\nHost: x\r\n\r\n");
+    request.parse();
+}
+
+void testMountedPaths()
+{
+    boson::Router inner;
+    std::string seenPath;
+    std::string seenUrl;
+    std::string seenId;
+    inner.get("/items/:id",
+              [&](const boson::Request& req, boson::Response&)
+              {
+                  seenPath = req.path();
+                  seenUrl = req.originalUrl();
+                  seenId = req.param("id");
+              });
+    inner.get("/", [&](const boson::Request& req, boson::Response&) { seenPath = req.path(); });
+
+    boson::Router outer;
+    outer.use("/shop", inner);
+    boson::Router root;
+    root.use("/api", outer);
+    root.get("/health", [&](const boson::Request& req, boson::Response&)
+             { seenPath = req.path(); });
+    root.freeze();
+
+    boson::Request request;
+    boson::Response response;
+
+    parseRequest(request, "GET", "/api/shop/items/7?full=1");
+    CHECK(root.handle(request, response));
+    CHECK(seenPath == "/items/7");
+    CHECK(seenUrl == "/api/shop/items/7?full=1");
+    CHECK(seenId == "7");
+
+    // Dispatching the same request again matches the full path, not the one handlers saw
+    seenPath.clear();
+    CHECK(root.handle(request, response));
+    CHECK(seenPath == "/items/7");
+
+    for (const char* target : {"/api/shop", "/api/shop/"})
+    {
+        seenPath.clear();
+        parseRequest(request, "GET", target);
+        CHECK(root.handle(request, response));
+        CHECK(seenPath == "/");
+    }
+
+    seenPath.clear();
+    parseRequest(request, "GET", "/health");
+    CHECK(root.handle(request, response));
+    CHECK(seenPath == "/health");
+    CHECK(request.pathView() == "/health");
+
+    parseRequest(request, "POST", "/api/shop/items/7");
+    CHECK(!root.handle(request, response));
+    CHECK(request.pathView() == "/api/shop/items/7");
+    CHECK(root.allowedMethods(request.pathView()) == "GET");
+}
+
+void testThrowingHandler()
+{
+    boson::Router inner;
+    inner.get("/fail", [](const boson::Request&, boson::Response&)
+              { throw std::runtime_error("handler failed"); });
+    inner.get("/ok", [](const boson::Request&, boson::Response& res) { res.send("ok"); });
+    boson::Router root;
+    root.use("/mounted", inner);
+    root.freeze();
+
+    boson::Request request;
+    boson::Response response;
+    parseRequest(request, "GET", "/mounted/fail");
+    bool threw = false;
+    try
+    {
+        root.handle(request, response);
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(request.originalUrl() == "/mounted/fail");
+
+    // Nothing was rewritten, so the next dispatch starts from the full path again
+    parseRequest(request, "GET", "/mounted/ok");
+    CHECK(root.handle(request, response));
+    CHECK(request.pathView() == "/ok");
+}
+
+class ItemController : public boson::Controller
+{
+  public:
+    std::string basePath() const override { return "/items"; }
+
+    void show(const boson::Request& req, boson::Response&) { seen = "show " + req.param("id"); }
+
+    void regex(const boson::Request& req, boson::Response&) { seen = "regex " + req.param("id"); }
+
+    std::string seen;
+};
+
+constexpr boson::RoutePattern kItemById("/:id");
+constexpr boson::RoutePattern kNumericItem("/n/:id/[0-9]+");
+static_assert(kItemById.paramCount() == 1 && !kItemById.usesRegex());
+static_assert(kNumericItem.usesRegex());
+
+void testBoundPatterns()
+{
+    auto controller = std::make_shared<ItemController>();
+    auto binder = boson::createRouter(controller);
+    binder.get<&ItemController::show, kItemById>();
+    binder.get<&ItemController::regex, kNumericItem>();
+    boson::Router root;
+    binder.mountOn(root);
+    root.freeze();
+
+    boson::Request request;
+    boson::Response response;
+    parseRequest(request, "GET", "/items/7");
+    CHECK(root.handle(request, response));
+    CHECK(controller->seen == "show 7");
+
+    parseRequest(request, "GET", "/items/n/42/7");
+    CHECK(root.handle(request, response));
+    CHECK(controller->seen == "regex 42");
+
+    parseRequest(request, "GET", "/items/n/42/x");
+    CHECK(!root.handle(request, response));
+}
+
+} // namespace
+
+int main()
+{
+    testMountedPaths();
+    testThrowingHandler();
+    testBoundPatterns();
+    return boson_test::result("router_test");
+}
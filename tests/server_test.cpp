@@ -0,0 +1,478 @@
+/**
+ * @file server_test.cpp
+ * @brief Round trips through a running Server with each I/O backend
+ *
+ * Starts a Server on the epoll, SO_REUSEPORT and io_uring backends in turn and talks to it
+ * over plain sockets: pipelined requests on one keep-alive connection, streamed responses
+ * (including ones the handler leaves open or abandons by throwing), requests framed with
+ * Transfer-Encoding, oversized requests, and idle connections being swept while another
+ * connection stays busy.
+ */
+
+#include "check.hpp"
+
+#include "boson/server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief One parsed response as the client saw it
+ */
+struct Reply
+{
+    int status = 0;
+    std::string head; ///< Status line and headers, lowercased
+    std::string body;
+
+    bool hasHeader(const std::string& line) const
+    {
+        return head.find("\r\n" + line + "\r\n") != std::string::npos;
+    }
+};
+
+/**
+ * @brief Blocking client connection with a receive timeout so a hung server fails the test
+ */
+class Client
+{
+  public:
+    explicit Client(int port)
+    {
+        // The server thread may still be binding its listeners
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            struct sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0)
+            {
+                struct timeval timeout = {5, 0};
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                return;
+            }
+            close(fd);
+            fd = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    ~Client()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    bool connected() const { return fd >= 0; }
+
+    bool send(const std::string& data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read the next response, framed by Content-Length or chunked encoding
+     * @return False if the connection closed or timed out first
+     */
+    bool read(Reply& reply)
+    {
+        size_t headEnd;
+        while ((headEnd = pending.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (!fill())
+            {
+                return false;
+            }
+        }
+        reply.head = pending.substr(0, headEnd + 2);
+        std::transform(reply.head.begin(), reply.head.end(), reply.head.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        reply.status = std::atoi(reply.head.c_str() + 9);
+        pending.erase(0, headEnd + 4);
+        reply.body.clear();
+
+        if (reply.hasHeader("transfer-encoding: chunked"))
+        {
+            while (true)
+            {
+                size_t lineEnd;
+                while ((lineEnd = pending.find("\r\n")) == std::string::npos)
+                {
+                    if (!fill())
+                    {
+                        return false;
+                    }
+                }
+                size_t size = std::stoul(pending.substr(0, lineEnd), nullptr, 16);
+                while (pending.size() < lineEnd + 2 + size + 2)
+                {
+                    if (!fill())
+                    {
+                        return false;
+                    }
+                }
+                reply.body.append(pending, lineEnd + 2, size);
+                pending.erase(0, lineEnd + 2 + size + 2);
+                if (size == 0)
+                {
+                    return true;
+                }
+            }
+        }
+
+        size_t lengthAt = reply.head.find("\r\ncontent-length: ");
+        size_t length =
+            lengthAt == std::string::npos ? 0 : std::stoul(reply.head.substr(lengthAt + 18));
+        while (pending.size() < length)
+        {
+            if (!fill())
+            {
+                return false;
+            }
+        }
+        reply.body = pending.substr(0, length);
+        pending.erase(0, length);
+        return true;
+    }
+
+    /**
+     * @brief Check that the server closed the connection with nothing more to read
+     */
+    bool closedByServer()
+    {
+        return pending.empty() && !fill() && closed;
+    }
+
+  private:
+    bool fill()
+    {
+        char chunk[16384];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+        {
+            closed = n == 0;
+            return false;
+        }
+        pending.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    int fd = -1;
+    std::string pending;
+    bool closed = false;
+};
+
+const char* const kBackends[] = {"epoll", "reuseport", "io_uring"};
+
+/**
+ * @brief A Server on its own thread, stopped when it goes out of scope
+ */
+class RunningServer
+{
+  public:
+    RunningServer(const std::string& backend, int port, int keepAliveSeconds = 5)
+    {
+        app.get("/items/:id",
+                [](const boson::Request& req, boson::Response& res)
+                { res.send("item " + req.param("id")); });
+        app.post("/echo", [](const boson::Request& req, boson::Response& res)
+                 { res.send(req.body()); });
+        app.get("/stream",
+                [](const boson::Request&, boson::Response& res)
+                {
+                    res.stream(true);
+                    res.header("Content-Type", "text/plain");
+                    for (int i = 0; i < 20; i++)
+                    {
+                        res.write("part " + std::to_string(i) + "\n");
+                    }
+                    res.end();
+                });
+        app.get("/unended",
+                [](const boson::Request&, boson::Response& res)
+                {
+                    res.stream(true);
+                    res.write("first ");
+                    res.write("second");
+                });
+        app.get("/throws-midstream",
+                [](const boson::Request&, boson::Response& res)
+                {
+                    res.stream(true);
+                    res.write("partial");
+                    throw std::runtime_error("handler failed");
+                });
+
+        if (backend == "reuseport")
+        {
+            app.setReusePort(true);
+        }
+        else if (backend == "io_uring")
+        {
+            app.setIoBackend(boson::IoBackend::IoUring);
+        }
+        app.setKeepAliveTimeout(keepAliveSeconds);
+        app.setMaxHeaderSize(1024);
+        app.setMaxBodySize(64);
+        app.configure(port, "127.0.0.1");
+        thread = std::thread([this]() { app.listen(); });
+    }
+
+    ~RunningServer()
+    {
+        app.stop();
+        thread.join();
+    }
+
+  private:
+    boson::Server app;
+    std::thread thread;
+};
+
+void testPipelinedKeepAlive(int port)
+{
+    Client client(port);
+    if (!CHECK(client.connected()))
+    {
+        return;
+    }
+
+    // Enough requests in one write to span several reads and response batches
+    std::string batch;
+    for (int i = 0; i < 200; i++)
+    {
+        batch += "GET /items/" + std::to_string(i) + " HTTP/1.1\r\nHost: x\r\n\r\n";
+        if (i % 50 == 0)
+        {
+            batch += "POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 6\r\n\r\nbody-" +
+                     std::to_string(i % 10);
+        }
+    }
+    CHECK(client.send(batch));
+
+    for (int i = 0; i < 200; i++)
+    {
+        Reply reply;
+        if (!CHECK(client.read(reply)))
+        {
+            return;
+        }
+        CHECK(reply.status == 200);
+        CHECK(reply.body == "item " + std::to_string(i));
+        CHECK(reply.hasHeader("connection: keep-alive"));
+        if (i % 50 == 0)
+        {
+            CHECK(client.read(reply));
+            CHECK(reply.body == "body-" + std::to_string(i % 10));
+        }
+    }
+
+    // The connection is still usable once the pipeline has drained
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Reply reply;
+    CHECK(client.send("GET /items/last HTTP/1.1\r\nHost: x\r\n\r\n"));
+    CHECK(client.read(reply) && reply.body == "item last");
+}
+
+void testStreamed(int port)
+{
+    Client client(port);
+    if (!CHECK(client.connected()))
+    {
+        return;
+    }
+
+    std::string expected;
+    for (int i = 0; i < 20; i++)
+    {
+        expected += "part " + std::to_string(i) + "\n";
+    }
+
+    CHECK(client.send("GET /items/before HTTP/1.1\r\nHost: x\r\n\r\n"
+                      "GET /stream HTTP/1.1\r\nHost: x\r\n\r\n"
+                      "GET /items/after HTTP/1.1\r\nHost: x\r\n\r\n"));
+    Reply reply;
+    CHECK(client.read(reply) && reply.body == "item before");
+    CHECK(client.read(reply));
+    CHECK(reply.hasHeader("transfer-encoding: chunked"));
+    CHECK(reply.hasHeader("connection: keep-alive"));
+    CHECK(reply.body == expected);
+    CHECK(client.read(reply) && reply.body == "item after");
+}
+
+/**
+ * @brief Streams the handler did not finish still leave the connection in a readable state
+ */
+void testUnfinishedStreams(int port)
+{
+    {
+        // Returning without end() terminates the body, and the pipeline carries on
+        Client client(port);
+        CHECK(client.send("GET /unended HTTP/1.1\r\nHost: x\r\n\r\n"
+                          "GET /items/after HTTP/1.1\r\nHost: x\r\n\r\n"));
+        Reply reply;
+        CHECK(client.read(reply) && reply.body == "first second");
+        CHECK(reply.hasHeader("connection: keep-alive"));
+        CHECK(client.read(reply) && reply.body == "item after");
+    }
+    {
+        // The head has gone out, so an exception can only be reported by closing
+        Client client(port);
+        CHECK(client.send("GET /throws-midstream HTTP/1.1\r\nHost: x\r\n\r\n"
+                          "GET /items/after HTTP/1.1\r\nHost: x\r\n\r\n"));
+        Reply reply;
+        CHECK(!client.read(reply));
+        CHECK(reply.body == "partial");
+        CHECK(client.closedByServer());
+    }
+}
+
+void testTransferEncodingRejected(int port)
+{
+    {
+        // The chunked body must not be read as the request that follows it
+        Client client(port);
+        CHECK(client.send("GET /items/1 HTTP/1.1\r\nHost: x\r\n\r\n"
+                          "POST /echo HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "24\r\nGET /items/smuggled HTTP/1.1\r\n\r\n\r\n0\r\n\r\n"));
+        Reply reply;
+        CHECK(client.read(reply) && reply.body == "item 1");
+        CHECK(client.read(reply) && reply.status == 501);
+        CHECK(reply.hasHeader("connection: close"));
+        CHECK(client.closedByServer());
+    }
+    {
+        Client client(port);
+        CHECK(client.send("POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n0\r\n\r\n"
+                          "GET /items/smuggled HTTP/1.1\r\nHost: x\r\n\r\n"));
+        Reply reply;
+        CHECK(client.read(reply) && reply.status == 400);
+        CHECK(reply.hasHeader("connection: close"));
+        CHECK(client.closedByServer());
+    }
+}
+
+void testOversizedRejected(int port)
+{
+    {
+        Client client(port);
+        CHECK(client.send("GET /items/1 HTTP/1.1\r\nHost: x\r\nX-Fill: " +
+                          std::string(2048, 'f') + "\r\n\r\n"));
+        Reply reply;
+        CHECK(client.read(reply) && reply.status == 431);
+        CHECK(reply.hasHeader("connection: close"));
+        CHECK(client.closedByServer());
+    }
+    {
+        // Answered after the responses to the requests before it, without waiting for the body
+        Client client(port);
+        CHECK(client.send("POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 64\r\n\r\n" +
+                          std::string(64, 'b') +
+                          "POST /echo HTTP/1.1\r\nHost: x\r\nContent-Length: 1000000\r\n\r\n"));
+        Reply reply;
+        CHECK(client.read(reply) && reply.body == std::string(64, 'b'));
+        CHECK(client.read(reply) && reply.status == 413);
+        CHECK(reply.hasHeader("connection: close"));
+        CHECK(client.closedByServer());
+    }
+}
+
+/**
+ * @brief Idle connections are closed by the sweep while a busy one keeps being served
+ */
+void testIdleSweep(int port)
+{
+    std::vector<std::unique_ptr<Client>> idle;
+    for (int i = 0; i < 16; i++)
+    {
+        idle.push_back(std::make_unique<Client>(port));
+        // Half of them leave a partial request behind
+        if (i % 2)
+        {
+            idle.back()->send("GET /items/partial HTTP/1.1\r\n");
+        }
+    }
+
+    Client busy(port);
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(2500);
+    int served = 0;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        Reply reply;
+        if (!CHECK(busy.send("GET /items/a HTTP/1.1\r\nHost: x\r\n\r\n"
+                             "GET /items/b HTTP/1.1\r\nHost: x\r\n\r\n")) ||
+            !CHECK(busy.read(reply) && reply.body == "item a") ||
+            !CHECK(busy.read(reply) && reply.body == "item b"))
+        {
+            break;
+        }
+        served += 2;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(served > 0);
+
+    for (auto& client : idle)
+    {
+        CHECK(client->closedByServer());
+    }
+}
+
+} // namespace
+
+int main()
+{
+    int port = 19380;
+    for (const char* backend : kBackends)
+    {
+        boson_test::context() = backend;
+        {
+            RunningServer server(backend, port);
+            testPipelinedKeepAlive(port);
+            testStreamed(port);
+            testUnfinishedStreams(port);
+            testTransferEncodingRejected(port);
+            testOversizedRejected(port);
+        }
+        port++;
+        {
+            RunningServer server(backend, port, 1);
+            testIdleSweep(port);
+        }
+        port++;
+    }
+    boson_test::context().clear();
+    return boson_test::result("server_test");
+}